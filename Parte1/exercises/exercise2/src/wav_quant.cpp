@@ -5,6 +5,154 @@
 #include <cmath>
 #include <algorithm>
 #include <iomanip>
+#include <cstdint>
+
+// Integer version of WAVQuantizer's rounding quantizer, specialized for each bit depth.
+// With maxLevel = 2^Bits - 1 the level is round((sample + 32768) * maxLevel / 65535);
+// 65535 is odd, so there are no exact ties and adding 32767 before the (constant)
+// division rounds the same way as std::round. The reconstruction level * 65535 / maxLevel
+// - 32768 is truncated towards zero, as the cast to short of the original double did.
+// All products fit in 32 bits, so the loop over a buffer vectorizes. Bit-identical to the
+// double formulas for every 16-bit sample and every bit depth (checked exhaustively).
+template <int Bits>
+struct IntegerQuantizer {
+    static constexpr uint32_t maxLevel = (1u << Bits) - 1;
+
+    static short quantize(short sample) {
+        uint32_t x = static_cast<uint16_t>(sample) ^ 0x8000;   // sample + 32768
+        uint32_t level = (x * maxLevel + 32767) / 65535;
+        uint32_t scaled = level * 65535;
+        uint32_t value = scaled / maxLevel;
+        // Below zero, truncating towards zero means rounding the quotient up
+        value += (value < 32768 && scaled % maxLevel != 0) ? 1 : 0;
+        return static_cast<short>(static_cast<uint16_t>(value) ^ 0x8000);
+    }
+
+    static void quantizeBlock(const short* input, short* output, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            output[i] = quantize(input[i]);
+        }
+    }
+};
+
+using QuantizeBlockFunction = void (*)(const short*, short*, size_t);
+
+// One instantiation per bit depth, selected once per file
+static const QuantizeBlockFunction quantizeBlockFunctions[16] = {
+    IntegerQuantizer<1>::quantizeBlock,  IntegerQuantizer<2>::quantizeBlock,
+    IntegerQuantizer<3>::quantizeBlock,  IntegerQuantizer<4>::quantizeBlock,
+    IntegerQuantizer<5>::quantizeBlock,  IntegerQuantizer<6>::quantizeBlock,
+    IntegerQuantizer<7>::quantizeBlock,  IntegerQuantizer<8>::quantizeBlock,
+    IntegerQuantizer<9>::quantizeBlock,  IntegerQuantizer<10>::quantizeBlock,
+    IntegerQuantizer<11>::quantizeBlock, IntegerQuantizer<12>::quantizeBlock,
+    IntegerQuantizer<13>::quantizeBlock, IntegerQuantizer<14>::quantizeBlock,
+    IntegerQuantizer<15>::quantizeBlock, IntegerQuantizer<16>::quantizeBlock
+};
+
+// Requantization modes. All but Plain add TPDF dither (the difference of two uniform
+// variables, +-1 step peak), which makes the quantization error independent of the
+// signal; the shaped modes also feed the error back through a filter h, so the error
+// spectrum becomes E(z)(1 - H(z)) and is pushed towards the frequencies where the ear
+// is least sensitive.
+enum class QuantizationMode {
+    Plain,      // Rounding to the nearest level (IntegerQuantizer)
+    Tpdf,       // TPDF dither, white error
+    Shaped,     // TPDF + first order shaping, 1 - z^-1
+    Lipshitz,   // TPDF + Lipshitz 5-tap shaping (44.1 kHz)
+    FWeighted   // TPDF + Wannamaker 9-tap F-weighted shaping (44.1 kHz)
+};
+
+// Error feedback coefficients for each shaped mode
+static const std::vector<double> shapingFilters[] = {
+    {},
+    {},
+    { 1.0 },
+    { 2.033, -2.165, 1.959, -1.590, 0.6149 },
+    { 2.412, -3.370, 3.937, -4.174, 3.353, -2.205, 1.281, -0.569, 0.0847 }
+};
+
+// Dithered, noise-shaped requantization of interleaved frames onto the same levels as
+// WAVQuantizer. The per-channel state is kept as structure of arrays: one row of
+// `channels` errors per filter tap (a ring buffer of rows) and one dither generator per
+// channel, so every step of a frame is a loop over the channels with no dependencies
+// between them, which the compiler vectorizes.
+class NoiseShaper {
+private:
+    int channels;
+    int order;
+    double step;
+    double maxLevel;
+    std::vector<double> coefs;
+    std::vector<double> errors;     // order rows (at least one) of channels errors, newest at row `newest`
+    int newest;
+    std::vector<uint64_t> rngState; // xorshift64 state of each channel
+    std::vector<double> target;     // Scratch: shaped input of each channel
+
+public:
+    NoiseShaper(int channels, int bits, QuantizationMode mode)
+        : channels(channels), step(65535.0 / ((1 << bits) - 1)), maxLevel((1 << bits) - 1),
+          coefs(shapingFilters[static_cast<int>(mode)]), newest(0), rngState(channels), target(channels) {
+        order = static_cast<int>(coefs.size());
+        errors.assign(static_cast<size_t>(std::max(order, 1)) * channels, 0.0);
+
+        // Fixed seeds (splitmix64 of the channel index): the output is reproducible
+        for (int c = 0; c < channels; c++) {
+            uint64_t z = 0x9E3779B97F4A7C15ULL * (c + 1);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            rngState[c] = (z ^ (z >> 31)) | 1;
+        }
+    }
+
+    void process(const short* input, short* output, size_t frames) {
+        const double invStep = 1.0 / step;
+        const double errorLimit = 1.5 * step;   // |error| <= 1.5 steps unless the signal clips
+
+        for (size_t f = 0; f < frames; f++) {
+            const short* in = input + f * channels;
+            short* out = output + f * channels;
+
+            // Shaped input: x[n] - sum h[k] e[n-1-k]
+            for (int c = 0; c < channels; c++) {
+                target[c] = in[c];
+            }
+            for (int k = 0; k < order; k++) {
+                const double* row = &errors[static_cast<size_t>((newest + k) % order) * channels];
+                const double h = coefs[k];
+                for (int c = 0; c < channels; c++) {
+                    target[c] -= h * row[c];
+                }
+            }
+
+            // The oldest row becomes the newest (without shaping the single row is never read)
+            if (order > 0) {
+                newest = (newest + order - 1) % order;
+            }
+            double* newRow = &errors[static_cast<size_t>(newest) * channels];
+
+            for (int c = 0; c < channels; c++) {
+                // TPDF dither: difference of the two 32-bit halves of one xorshift64 draw
+                uint64_t x = rngState[c];
+                x ^= x << 13;
+                x ^= x >> 7;
+                x ^= x << 17;
+                rngState[c] = x;
+                double dither = (static_cast<double>(static_cast<int32_t>(x >> 32)) -
+                                 static_cast<double>(static_cast<int32_t>(x))) * (1.0 / 4294967296.0);
+
+                // Same levels and reconstruction as the plain quantizer (truncation to short)
+                double level = (target[c] + 32768.0) * invStep + dither;
+                level = std::min(std::max(level, 0.0), maxLevel);
+                int quantizedLevel = static_cast<int>(level + 0.5);
+                short quantized = static_cast<short>(static_cast<int>(-32768.0 + quantizedLevel * step));
+                out[c] = quantized;
+
+                double error = quantized - target[c];
+                newRow[c] = std::min(std::max(error, -errorLimit), errorLimit);
+            }
+        }
+    }
+};
 
 class WAVQuantizer {
 private:
@@ -16,6 +164,7 @@ private:
     double quantizationStep;
     double maxValue;
     double minValue;
+    QuantizeBlockFunction quantizeBlock;
     
     // Statistics
     size_t totalSamples;
@@ -63,6 +212,7 @@ public:
         
         // Quantization step
         quantizationStep = (maxValue - minValue) / (numLevels - 1);
+        quantizeBlock = quantizeBlockFunctions[targetBits - 1];
         
         std::cout << "Quantization parameters:" << std::endl;
         std::cout << "  Target bits: " << targetBits << std::endl;
@@ -72,28 +222,16 @@ public:
     }
     
     short quantizeSample(short originalSample) {
-        double sample = static_cast<double>(originalSample);
-        
-        // Normalize to [0, numLevels-1]
-        double normalized = (sample - minValue) / quantizationStep;
-        
-        // Round to nearest quantization level
-        int quantizedLevel = static_cast<int>(std::round(normalized));
-        
-        // Clamp to valid range
-        quantizedLevel = std::max(0, std::min(quantizedLevel, (1 << targetBits) - 1));
-        
-        // Convert back to sample value
-        double quantizedSample = minValue + quantizedLevel * quantizationStep;
-        
-        // Convert back to short, clamping to 16-bit range
-        return static_cast<short>(std::max(-32768.0, std::min(32767.0, quantizedSample)));
+        short quantized;
+        quantizeBlock(&originalSample, &quantized, 1);
+        return quantized;
     }
     
-    void processFile() {
+    void processFile(QuantizationMode mode = QuantizationMode::Plain) {
         const size_t bufferSize = 4096;
         std::vector<short> inputBuffer(bufferSize);
         std::vector<short> outputBuffer(bufferSize);
+        NoiseShaper shaper(inputInfo.channels, targetBits, mode);
         
         sf_count_t framesRead;
         double sumSquaredError = 0.0;
@@ -104,11 +242,16 @@ public:
         while ((framesRead = sf_readf_short(inputFile, inputBuffer.data(), bufferSize / inputInfo.channels)) > 0) {
             size_t samplesRead = framesRead * inputInfo.channels;
             
-            // Quantize each sample
+            // Quantize the whole buffer
+            if (mode == QuantizationMode::Plain) {
+                quantizeBlock(inputBuffer.data(), outputBuffer.data(), samplesRead);
+            } else {
+                shaper.process(inputBuffer.data(), outputBuffer.data(), framesRead);
+            }
+            
             for (size_t i = 0; i < samplesRead; i++) {
                 short original = inputBuffer[i];
-                short quantized = quantizeSample(original);
-                outputBuffer[i] = quantized;
+                short quantized = outputBuffer[i];
                 
                 // Calculate error statistics
                 double error = static_cast<double>(original - quantized);
@@ -160,11 +303,19 @@ void printUsage(const char* programName) {
     std::cout << std::endl;
     std::cout << "Options:" << std::endl;
     std::cout << "  -v, --verbose    - Verbose output with file information" << std::endl;
+    std::cout << "  -m, --mode MODE  - Requantization mode (default: plain):" << std::endl;
+    std::cout << "                       plain      - round to the nearest level" << std::endl;
+    std::cout << "                       tpdf       - TPDF dither (error independent of the signal)" << std::endl;
+    std::cout << "                       shaped     - TPDF dither + first order noise shaping" << std::endl;
+    std::cout << "                       lipshitz   - TPDF dither + Lipshitz 5-tap noise shaping" << std::endl;
+    std::cout << "                       f-weighted - TPDF dither + 9-tap F-weighted noise shaping" << std::endl;
+    std::cout << "                     (the lipshitz and f-weighted filters are designed for 44.1 kHz)" << std::endl;
     std::cout << "  -h, --help       - Show this help message" << std::endl;
     std::cout << std::endl;
     std::cout << "Examples:" << std::endl;
     std::cout << "  " << programName << " input.wav output_8bit.wav 8" << std::endl;
     std::cout << "  " << programName << " input.wav output_4bit.wav 4 -v" << std::endl;
+    std::cout << "  " << programName << " input.wav output_6bit.wav 6 -m f-weighted" << std::endl;
 }
 
 int main(int argc, char* argv[]) {
@@ -178,12 +329,25 @@ int main(int argc, char* argv[]) {
     int targetBits = std::atoi(argv[3]);
     
     bool verbose = false;
+    QuantizationMode mode = QuantizationMode::Plain;
+    std::string modeName = "plain";
     
     // Parse options
     for (int i = 4; i < argc; i++) {
         std::string arg = argv[i];
         if (arg == "-v" || arg == "--verbose") {
             verbose = true;
+        } else if ((arg == "-m" || arg == "--mode") && i + 1 < argc) {
+            std::string name = modeName = argv[++i];
+            if (name == "plain") mode = QuantizationMode::Plain;
+            else if (name == "tpdf") mode = QuantizationMode::Tpdf;
+            else if (name == "shaped") mode = QuantizationMode::Shaped;
+            else if (name == "lipshitz") mode = QuantizationMode::Lipshitz;
+            else if (name == "f-weighted") mode = QuantizationMode::FWeighted;
+            else {
+                std::cerr << "Error: Unknown mode '" << name << "'" << std::endl;
+                return 1;
+            }
         } else if (arg == "-h" || arg == "--help") {
             printUsage(argv[0]);
             return 0;
@@ -200,6 +364,7 @@ int main(int argc, char* argv[]) {
         std::cout << "WAV Quantizer - Reducing audio to " << targetBits << " bits per sample" << std::endl;
         std::cout << "Input: " << inputPath << std::endl;
         std::cout << "Output: " << outputPath << std::endl;
+        std::cout << "Mode: " << modeName << std::endl;
         std::cout << "===========================================" << std::endl;
         
         WAVQuantizer quantizer(inputPath, outputPath, targetBits);
@@ -209,7 +374,7 @@ int main(int argc, char* argv[]) {
             std::cout << std::endl;
         }
         
-        quantizer.processFile();
+        quantizer.processFile(mode);
         
         std::cout << "\nQuantization Results Summary:" << std::endl;
         std::cout << "  Original bits: 16" << std::endl;
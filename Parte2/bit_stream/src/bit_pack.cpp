@@ -0,0 +1,173 @@
+//-------------------------------------------------------------------------------------------
+//
+// Empacotamento em bloco - Implementação
+//
+//-------------------------------------------------------------------------------------------
+
+#include "bit_pack.h"
+#include <bit>
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+//-------------------------------------------------------------------------------------------
+// Leitura / escrita de palavras big-endian
+//-------------------------------------------------------------------------------------------
+
+// Troca a ordem dos bytes em máquinas little-endian (o formato é MSB primeiro)
+static inline uint64_t to_big_endian(uint64_t word) {
+    if constexpr (endian::native == endian::little) {
+        return __builtin_bswap64(word);
+    } else {
+        return word;
+    }
+}
+
+// Escreve os n bytes mais significativos de word (n <= 8)
+static inline void store_top_bytes(uint8_t* out, uint64_t word, int n) {
+    word = to_big_endian(word);
+    memcpy(out, &word, n);
+}
+
+// Lê n bytes (n <= 8) para os bytes mais significativos de uma palavra
+static inline uint64_t load_top_bytes(const uint8_t* in, int n) {
+    uint64_t word = 0;
+    memcpy(&word, in, n);
+    return to_big_endian(word);
+}
+
+//-------------------------------------------------------------------------------------------
+// Grupos de 8 valores (8 * K bits = K bytes)
+//-------------------------------------------------------------------------------------------
+
+// Até 8 bits o grupo cabe numa palavra de 64 bits; acima disso usa 128 bits, escritos
+// como duas palavras. Com Wide, as palavras são lidas/escritas com 8 bytes inteiros
+// (mais rápido que K bytes quando K é ímpar): os bytes a mais são os do grupo seguinte,
+// pelo que só pode ser usado com pelo menos 16 bytes de buffer a partir do grupo e, na
+// escrita, com os grupos por ordem
+template <int K, bool Wide>
+static inline void pack_group(const uint16_t* values, uint8_t* out) {
+    constexpr uint32_t mask = (1u << K) - 1;
+
+    if constexpr (K <= 8) {
+        uint64_t acc = 0;
+        for (int i = 0; i < 8; i++) {
+            acc = (acc << K) | (values[i] & mask);
+        }
+        store_top_bytes(out, acc << (64 - 8 * K), Wide ? 8 : K);
+    } else {
+        unsigned __int128 acc = 0;
+        for (int i = 0; i < 8; i++) {
+            acc = (acc << K) | (values[i] & mask);
+        }
+        acc <<= 128 - 8 * K;
+        store_top_bytes(out, static_cast<uint64_t>(acc >> 64), 8);
+        store_top_bytes(out + 8, static_cast<uint64_t>(acc), Wide ? 8 : K - 8);
+    }
+}
+
+template <int K, bool Wide>
+static inline void unpack_group(const uint8_t* in, uint16_t* values) {
+    constexpr uint32_t mask = (1u << K) - 1;
+
+    if constexpr (K <= 8) {
+        uint64_t acc = load_top_bytes(in, Wide ? 8 : K) >> (64 - 8 * K);
+        for (int i = 0; i < 8; i++) {
+            values[i] = static_cast<uint16_t>((acc >> (K * (7 - i))) & mask);
+        }
+    } else {
+        uint64_t low = load_top_bytes(in + 8, Wide ? 8 : K - 8);
+        if constexpr (Wide) {
+            low &= ~uint64_t(0) << (128 - 8 * K);
+        }
+        unsigned __int128 acc = (static_cast<unsigned __int128>(load_top_bytes(in, 8)) << 64) | low;
+        acc >>= 128 - 8 * K;
+        for (int i = 0; i < 8; i++) {
+            values[i] = static_cast<uint16_t>(static_cast<uint64_t>(acc >> (K * (7 - i))) & mask);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// Arrays
+//-------------------------------------------------------------------------------------------
+
+// Grupos completos que têm pelo menos 16 bytes de buffer a partir do início
+template <int K>
+static inline size_t wide_groups(size_t count) {
+    size_t bytes = bit_packed_bytes(count, K);
+    return bytes < 16 ? 0 : min(count / 8, (bytes - 16) / K + 1);
+}
+
+// O último grupo incompleto passa por um grupo temporário completado com zeros
+template <int K>
+static void pack_array(const uint16_t* values, size_t count, uint8_t* out) {
+    size_t wide = wide_groups<K>(count);
+    size_t groups = count / 8;
+    for (size_t g = 0; g < wide; g++) {
+        pack_group<K, true>(values + 8 * g, out + K * g);
+    }
+    for (size_t g = wide; g < groups; g++) {
+        pack_group<K, false>(values + 8 * g, out + K * g);
+    }
+
+    size_t rest = count % 8;
+    if (rest > 0) {
+        uint16_t tail_values[8] = {};
+        uint8_t tail_bytes[K];
+        copy(values + 8 * groups, values + count, tail_values);
+        pack_group<K, false>(tail_values, tail_bytes);
+        memcpy(out + K * groups, tail_bytes, bit_packed_bytes(rest, K));
+    }
+}
+
+template <int K>
+static void unpack_array(const uint8_t* in, size_t count, uint16_t* values) {
+    size_t wide = wide_groups<K>(count);
+    size_t groups = count / 8;
+    for (size_t g = 0; g < wide; g++) {
+        unpack_group<K, true>(in + K * g, values + 8 * g);
+    }
+    for (size_t g = wide; g < groups; g++) {
+        unpack_group<K, false>(in + K * g, values + 8 * g);
+    }
+
+    size_t rest = count % 8;
+    if (rest > 0) {
+        uint8_t tail_bytes[K] = {};
+        uint16_t tail_values[8];
+        memcpy(tail_bytes, in + K * groups, bit_packed_bytes(rest, K));
+        unpack_group<K, false>(tail_bytes, tail_values);
+        copy(tail_values, tail_values + rest, values + 8 * groups);
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// Seleção da versão para cada número de bits
+//-------------------------------------------------------------------------------------------
+
+using PackFunction = void (*)(const uint16_t*, size_t, uint8_t*);
+using UnpackFunction = void (*)(const uint8_t*, size_t, uint16_t*);
+
+static const PackFunction pack_functions[BIT_PACK_MAX_BITS] = {
+    pack_array<1>,  pack_array<2>,  pack_array<3>,  pack_array<4>,
+    pack_array<5>,  pack_array<6>,  pack_array<7>,  pack_array<8>,
+    pack_array<9>,  pack_array<10>, pack_array<11>, pack_array<12>,
+    pack_array<13>, pack_array<14>, pack_array<15>, pack_array<16>
+};
+
+static const UnpackFunction unpack_functions[BIT_PACK_MAX_BITS] = {
+    unpack_array<1>,  unpack_array<2>,  unpack_array<3>,  unpack_array<4>,
+    unpack_array<5>,  unpack_array<6>,  unpack_array<7>,  unpack_array<8>,
+    unpack_array<9>,  unpack_array<10>, unpack_array<11>, unpack_array<12>,
+    unpack_array<13>, unpack_array<14>, unpack_array<15>, unpack_array<16>
+};
+
+void bit_pack(const uint16_t* values, size_t count, int bits, uint8_t* out) {
+    pack_functions[bits - 1](values, count, out);
+}
+
+void bit_unpack(const uint8_t* in, size_t count, int bits, uint16_t* values) {
+    unpack_functions[bits - 1](in, count, values);
+}
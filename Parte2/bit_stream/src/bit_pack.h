@@ -0,0 +1,41 @@
+//-------------------------------------------------------------------------------------------
+//
+// Empacotamento em bloco de valores de largura fixa (1 a 16 bits)
+//
+// Converte arrays de valores de k bits de e para bytes no mesmo formato do BitStream
+// (MSB primeiro, último byte completado com zeros), sem passar pelo acumulador bit a
+// bit. Os valores são processados em grupos de 8, que ocupam exatamente k bytes: há
+// uma versão do ciclo para cada k (template), com deslocamentos constantes que o
+// compilador desenrola.
+//
+//-------------------------------------------------------------------------------------------
+
+#ifndef BIT_PACK_H
+#define BIT_PACK_H
+
+#include <cstdint>
+#include <cstddef>
+
+const int BIT_PACK_MAX_BITS = 16;
+
+/**
+ * @brief Bytes ocupados por count valores de bits bits
+ */
+inline size_t bit_packed_bytes(size_t count, int bits) {
+    return (count * bits + 7) / 8;
+}
+
+/**
+ * @brief Empacota count valores de bits bits (1 a 16) em bit_packed_bytes(count, bits) bytes
+ *
+ * Só são usados os bits menos significativos de cada valor. Se count não for
+ * múltiplo de 8, o último byte é completado com zeros, como em BitStream::close().
+ */
+void bit_pack(const uint16_t* values, size_t count, int bits, uint8_t* out);
+
+/**
+ * @brief Desempacota count valores de bits bits (1 a 16) de bit_packed_bytes(count, bits) bytes
+ */
+void bit_unpack(const uint8_t* in, size_t count, int bits, uint16_t* values);
+
+#endif
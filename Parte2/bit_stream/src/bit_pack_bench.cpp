@@ -0,0 +1,138 @@
+//-------------------------------------------------------------------------------------------
+//
+// Bit Pack Benchmark - Débito de bit_pack/bit_unpack contra write_n_bits/read_n_bits
+//
+// Para cada número de bits compara os bytes produzidos com os do BitStream (valor a
+// valor) e mede o débito das duas versões em MB/s de amostras de 16 bits.
+//
+//-------------------------------------------------------------------------------------------
+
+#include "bit_pack.h"
+#include "bit_stream.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief Valores pseudo-aleatórios de bits bits
+ */
+vector<uint16_t> make_values(size_t count, int bits) {
+    vector<uint16_t> values(count);
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (auto& v : values) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        v = static_cast<uint16_t>(x >> (64 - bits));
+    }
+    return values;
+}
+
+/**
+ * @brief Lê o ficheiro inteiro
+ */
+vector<uint8_t> read_file(const string& file) {
+    ifstream ifs(file, ios::binary);
+    return vector<uint8_t>(istreambuf_iterator<char>(ifs), istreambuf_iterator<char>());
+}
+
+double seconds_since(chrono::high_resolution_clock::time_point start) {
+    return chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+}
+
+/**
+ * @brief Compara e mede as duas versões para um número de bits
+ * @return true se os bytes e os valores desempacotados coincidirem
+ */
+bool bench_bits(int bits, size_t count, const string& tmp_file) {
+    vector<uint16_t> values = make_values(count, bits);
+
+    // Referência: BitStream valor a valor
+    auto start = chrono::high_resolution_clock::now();
+    {
+        fstream ofs(tmp_file, ios::out | ios::binary);
+        BitStream bs(ofs, STREAM_WRITE);
+        for (uint16_t v : values) {
+            bs.write_n_bits(v, bits);
+        }
+        bs.close();
+    }
+    double serial_write = seconds_since(start);
+
+    start = chrono::high_resolution_clock::now();
+    vector<uint16_t> serial_values(count);
+    {
+        BitStream bs(tmp_file);
+        for (auto& v : serial_values) {
+            v = static_cast<uint16_t>(bs.read_n_bits(bits));
+        }
+        bs.close();
+    }
+    double serial_read = seconds_since(start);
+    vector<uint8_t> reference = read_file(tmp_file);
+
+    // Em bloco, memória a memória
+    vector<uint8_t> packed(bit_packed_bytes(count, bits));
+    start = chrono::high_resolution_clock::now();
+    bit_pack(values.data(), count, bits, packed.data());
+    double pack_time = seconds_since(start);
+
+    vector<uint16_t> unpacked(count);
+    start = chrono::high_resolution_clock::now();
+    bit_unpack(packed.data(), count, bits, unpacked.data());
+    double unpack_time = seconds_since(start);
+
+    // Contagens que não são múltiplas de 8: os bits do último byte depois do último
+    // valor têm de ser zero
+    bool ok = packed == reference && unpacked == values && serial_values == values;
+    for (size_t n = 1; n <= 17 && ok; n++) {
+        vector<uint8_t> tail(bit_packed_bytes(n, bits));
+        vector<uint16_t> tail_values(n);
+        bit_pack(values.data(), n, bits, tail.data());
+        bit_unpack(tail.data(), n, bits, tail_values.data());
+
+        size_t last = tail.size() - 1;
+        int last_bits = static_cast<int>(n * bits - 8 * last);
+        uint8_t last_mask = static_cast<uint8_t>(0xFF << (8 - last_bits));
+        ok = equal(tail.begin(), tail.begin() + last, reference.begin()) &&
+             tail[last] == (reference[last] & last_mask) &&
+             equal(tail_values.begin(), tail_values.end(), values.begin());
+    }
+
+    double megabytes = 2.0 * count / 1e6;
+    cout << setw(6) << bits
+         << setw(12) << setprecision(0) << megabytes / serial_write
+         << setw(12) << megabytes / serial_read
+         << setw(12) << megabytes / pack_time
+         << setw(12) << megabytes / unpack_time
+         << setw(8) << (ok ? "OK" : "ERRO") << endl;
+
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    // Valores por teste (default: 10 minutos de áudio estéreo a 44.1 kHz)
+    size_t count = (argc > 1) ? strtoull(argv[1], nullptr, 10) : size_t(44100) * 600 * 2;
+    string tmp_file = "bit_pack_bench.tmp";
+
+    cout << "Bit Pack Benchmark" << endl;
+    cout << "==================" << endl;
+    cout << fixed;
+    cout << setw(6) << "Bits" << setw(12) << "Escr. MB/s" << setw(12) << "Leit. MB/s"
+         << setw(12) << "Pack MB/s" << setw(12) << "Unpack MB/s" << setw(8) << "Check" << endl;
+
+    bool ok = true;
+    for (int bits = 1; bits <= BIT_PACK_MAX_BITS; bits++) {
+        ok = bench_bits(bits, count, tmp_file) && ok;
+    }
+
+    remove(tmp_file.c_str());
+    return ok ? 0 : 1;
+}
@@ -20,52 +20,141 @@
 #include <fstream>
 #include <string>
 #include <iostream>  // ADICIONADO: necessário para std::cout e std::cerr
+#include <algorithm>
 #include "bit_stream.h"
 
 using namespace std;
 
 BitStream::BitStream(std::fstream& fs, bool rw_status) 
-    : m_rw_status(rw_status), m_byte_stream(fs, rw_status),
-      m_buf(0), m_total_bits(0), m_is_open(true) {
-    
-    if(m_rw_status == STREAM_READ) {
-        m_bit_ptr = 8; // Forçar leitura no primeiro acesso
-    } else {
-        m_bit_ptr = 0; // Começar do MSB
+    : m_rw_status(rw_status), m_acc(0), m_acc_bits(0), m_byte_stream(fs, rw_status),
+      m_total_bits(0), m_is_open(true) {
+}
+
+BitStream::BitStream(const std::string& filename)
+    : m_rw_status(STREAM_READ), m_acc(0), m_acc_bits(0), m_byte_stream(filename),
+      m_total_bits(0), m_is_open(m_byte_stream.is_open()) {
+}
+
+void BitStream::put_word(uint64_t word) {
+    uint8_t bytes[8];
+    for(int i = 7 ; i >= 0 ; --i) {
+        bytes[i] = word & 0xFF;     // MSB fica no primeiro byte
+        word >>= 8;
     }
+
+    m_byte_stream.write(bytes, 8);
+}
+
+void BitStream::put_pending_bits() {
+    if(m_acc_bits == 0)
+        return;
+
+    // Alinhar os bits pendentes a esquerda do ultimo byte (padding de zeros)
+    int n_bytes = (m_acc_bits + 7) / 8;
+    uint64_t word = m_acc << (8 * n_bytes - m_acc_bits);
+    for(int i = n_bytes - 1 ; i >= 0 ; --i)
+        m_byte_stream.put((word >> (8 * i)) & 0xFF);
+
+    m_acc = 0;
+    m_acc_bits = 0;
+}
+
+void BitStream::fill_acc() {
+    uint8_t bytes[8];
+    size_t n_bytes = m_byte_stream.read(bytes, (64 - m_acc_bits) / 8);
+    for(size_t i = 0 ; i < n_bytes ; ++i)
+        m_acc = (m_acc << 8) | bytes[i];
+
+    m_acc_bits += 8 * n_bytes;
 }
 
 int BitStream::read_bit() {
     validate_read_mode();
     
-    if(m_bit_ptr >= 8) {
-        int next_byte = m_byte_stream.get();
-        if(next_byte == EOF)
+    if(m_acc_bits == 0) {
+        fill_acc();
+        if(m_acc_bits == 0)
             return EOF;
-        m_buf = next_byte;
-        m_bit_ptr = 0;
     }
 
-    int bit = (m_buf >> (7 - m_bit_ptr)) & 0x01;
-    m_bit_ptr++;
     m_total_bits++;
-    
-    return bit;
+    return (m_acc >> --m_acc_bits) & 0x01;
 }
 
 uint64_t BitStream::read_n_bits(int n) {
-    uint64_t x { };
-    for(int i = 0 ; i < n ; ++i) {
-        int bit = read_bit();
-        if(bit == EOF) {
-            // CORRIGIDO: retornar valor válido mesmo com EOF
-            return x;
+    if(n <= 0)
+        return 0;
+
+    if(n > 32) {
+        // Dividir em duas leituras para que cada uma caiba num so refill
+        uint64_t x = read_n_bits(n - 32);
+        return (x << 32) | read_n_bits(32);
+    }
+
+    validate_read_mode();
+
+    if(m_acc_bits < n) {
+        fill_acc();
+        if(m_acc_bits < n) {
+            // EOF: retornar os bits que restam (valor valido mesmo com EOF)
+            n = m_acc_bits;
+            if(n == 0)
+                return 0;
+        }
+    }
+
+    m_acc_bits -= n;
+    m_total_bits += n;
+    return (m_acc >> m_acc_bits) & ((uint64_t(1) << n) - 1);
+}
+
+uint64_t BitStream::peek_n_bits(int n) {
+    if(n <= 0)
+        return 0;
+
+    validate_read_mode();
+
+    if(m_acc_bits < n) {
+        fill_acc();
+        if(m_acc_bits < n) // EOF: completar com zeros
+            return (m_acc << (n - m_acc_bits)) & ((uint64_t(1) << n) - 1);
+    }
+
+    return (m_acc >> (m_acc_bits - n)) & ((uint64_t(1) << n) - 1);
+}
+
+void BitStream::skip_n_bits(int n) {
+    n = std::min(n, m_acc_bits);
+    m_acc_bits -= n;
+    m_total_bits += n;
+}
+
+size_t BitStream::read_bytes(uint8_t* data, size_t n) {
+    validate_read_mode();
+
+    size_t n_read = 0;
+    if(m_acc_bits % 8 != 0) {
+        // Fora do alinhamento ao byte: um byte de cada vez pelo acumulador
+        for( ; n_read < n ; ++n_read) {
+            if(m_acc_bits < 8) {
+                fill_acc();
+                if(m_acc_bits < 8)
+                    break;
+            }
+            m_acc_bits -= 8;
+            data[n_read] = (m_acc >> m_acc_bits) & 0xFF;
+        }
+    } else {
+        // Primeiro os bytes ja lidos para o acumulador, depois o resto diretamente
+        for( ; n_read < n && m_acc_bits > 0 ; ++n_read) {
+            m_acc_bits -= 8;
+            data[n_read] = (m_acc >> m_acc_bits) & 0xFF;
         }
-        x <<= 1;
-        x |= bit;
+        n_read += m_byte_stream.read(data + n_read, n - n_read);
     }
 
-    return x;
+    m_total_bits += 8 * n_read;
+    return n_read;
 }
 
 string BitStream::read_string() {
@@ -81,22 +170,56 @@ string BitStream::read_string() {
 void BitStream::write_bit(int bit) {
     validate_write_mode();
     
-    // CORRIGIDO: usar máscara correta e posição MSB
-    m_buf |= (bit & 0x01) << (7 - m_bit_ptr);
-    m_bit_ptr++;
-    
-    if(m_bit_ptr >= 8) {
-        m_byte_stream.put(m_buf);
-        m_bit_ptr = 0;
-        m_buf = 0;
+    m_acc = (m_acc << 1) | (bit & 0x01);
+    if(++m_acc_bits == 64) {
+        put_word(m_acc);
+        m_acc = 0;
+        m_acc_bits = 0;
     }
     
     m_total_bits++;
 }
 
 void BitStream::write_n_bits(uint64_t bits, int n) {
-    for(int i = n - 1 ; i >= 0 ; i--)
-        write_bit(((0x01 << i) & bits) >> i);
+    if(n <= 0)
+        return;
+
+    validate_write_mode();
+
+    if(n < 64)
+        bits &= (uint64_t(1) << n) - 1;
+    m_total_bits += n;
+
+    int room = 64 - m_acc_bits;
+    if(n < room) {
+        m_acc = (m_acc << n) | bits;
+        m_acc_bits += n;
+        return;
+    }
+
+    // O acumulador fica cheio: completa-lo com os bits mais significativos do
+    // campo, escreve-lo e guardar os restantes
+    int rest = n - room;
+    m_acc = room == 64 ? bits : (m_acc << room) | (bits >> rest);
+    put_word(m_acc);
+    m_acc = bits & ((uint64_t(1) << rest) - 1);
+    m_acc_bits = rest;
+}
+
+void BitStream::write_bytes(const uint8_t* data, size_t n) {
+    validate_write_mode();
+
+    if(m_acc_bits % 8 != 0) {
+        for(size_t i = 0 ; i < n ; ++i)
+            write_n_bits(data[i], 8);
+        return;
+    }
+
+    // Alinhado ao byte: os bytes pendentes no acumulador saem sem padding e os
+    // dados vao diretamente para o ByteStream
+    put_pending_bits();
+    m_byte_stream.write(data, n);
+    m_total_bits += 8 * n;
 }
 
 void BitStream::write_string(const string& s) {
@@ -107,24 +230,26 @@ void BitStream::write_string(const string& s) {
 }
 
 off_t BitStream::tell() {
-    return m_byte_stream.tell();
+    // Os bytes inteiros ainda no acumulador contam para a posicao logica
+    if(m_rw_status == STREAM_WRITE)
+        return m_byte_stream.tell() + m_acc_bits / 8;
+
+    return m_byte_stream.tell() - m_acc_bits / 8;
 }
 
 void BitStream::flush() {
-    if(m_rw_status == STREAM_WRITE && m_bit_ptr > 0) {
-        // Escrever byte parcial com padding de zeros
-        m_byte_stream.put(m_buf);
-        m_bit_ptr = 0;
-        m_buf = 0;
+    if(m_rw_status == STREAM_WRITE) {
+        // Escrever bits pendentes com padding de zeros
+        put_pending_bits();
     }
     m_byte_stream.flush();
 }
 
 void BitStream::close() {
     if(m_is_open) {
-        if(m_rw_status == STREAM_WRITE && m_bit_ptr > 0) {
-            // Escrever byte parcial antes de fechar
-            m_byte_stream.put(m_buf);
+        if(m_rw_status == STREAM_WRITE) {
+            // Escrever bits pendentes antes de fechar
+            put_pending_bits();
         }
         m_byte_stream.close();
         m_is_open = false;
@@ -136,7 +261,7 @@ void BitStream::debug_status() {
     std::cout << "Mode: " << (m_rw_status ? "READ" : "WRITE") << std::endl;
     std::cout << "Open: " << (m_is_open ? "YES" : "NO") << std::endl;
     std::cout << "Bits processed: " << m_total_bits << std::endl;
-    std::cout << "Current bit position: " << m_bit_ptr << std::endl;
+    std::cout << "Bits in accumulator: " << m_acc_bits << std::endl;
     std::cout << "Byte stream position: " << m_byte_stream.tell() << std::endl;
     std::cout << "=============================" << std::endl;
 }
@@ -147,8 +272,8 @@ bool BitStream::at_eof() const {
     }
     
     // MELHORADO: implementação mais robusta do EOF
-    // Se ainda há bits no buffer, não estamos em EOF
-    if(m_bit_ptr < 8 && m_bit_ptr >= 0) {
+    // Se ainda há bits no acumulador, não estamos em EOF
+    if(m_acc_bits > 0) {
         return false;
     }
     
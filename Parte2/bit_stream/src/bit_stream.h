@@ -23,11 +23,15 @@
 #include <fstream>
 #include "byte_stream.h"
 
+// Os bits passam por um acumulador de 64 bits: na escrita sao enviados para o
+// ByteStream uma palavra de cada vez e na leitura sao lidos ate 8 bytes de uma vez,
+// pelo que um campo de n bits custa O(1) em vez de n chamadas a read_bit/write_bit.
+// O formato do ficheiro nao muda (MSB primeiro, ultimo byte completado com zeros).
 class BitStream {
   private:
 	bool		m_rw_status { STREAM_READ };		//indica se o stream esta em modo leitura(true) ou escrita(false)
-	int			m_buf;								//buffer interno para armazenar bits temporariamente
-	int			m_bit_ptr;							//ponteiro que indica a posição atual do bit dentro do buffer
+	uint64_t	m_acc;								//acumulador de 64 bits (bits alinhados a direita)
+	int			m_acc_bits;							//numero de bits validos no acumulador
 	ByteStream	m_byte_stream;						// instancia de ByteStream que gere o acesso aos bytes subjacentes
 
 	//contador de bits processados
@@ -37,6 +41,7 @@ class BitStream {
 
   public:
 	BitStream(std::fstream& fs, bool rw_status);	//inputs: filestream e modo de operaçao
+	BitStream(const std::string& filename);			//so leitura, com o ficheiro mapeado em memoria quando possivel
 
 	BitStream() = delete;
 	BitStream(const BitStream&) = delete;
@@ -46,14 +51,19 @@ class BitStream {
 
 	int read_bit();					//le um unico bit
 	uint64_t read_n_bits(int n);	//le 'n' bits e retorna como uint64_t
+	uint64_t peek_n_bits(int n);	//os proximos 'n' bits (n <= 32) sem os consumir, com zeros depois do EOF
+	void skip_n_bits(int n);		//consome 'n' bits ja vistos com peek_n_bits
+	size_t read_bytes(uint8_t* data, size_t n);	//le ate 'n' bytes de uma vez (em bloco se alinhado ao byte); retorna quantos leu
 	std::string read_string();		//le uma string codificada bit a bit
 	void write_bit(int bit);		//escreve um unico bit
 	void write_n_bits(uint64_t bits, int n);		//escreve 'n' bits de um valor
+	void write_bytes(const uint8_t* data, size_t n);	//escreve 'n' bytes de uma vez (em bloco se alinhado ao byte)
 	void write_string(const std::string& s);		//escreve uma string
 	off_t tell();									//retorna a posiçao atual no stream
 	void close();									//fecha o stream
 
 	bool is_open() const {return m_is_open; }		//metodo para verificar se o stream esta aberto
+	bool is_mapped() const {return m_byte_stream.is_mapped(); }	//indica se a leitura e feita via mmap
 	uint64_t get_total_bits() const {return m_total_bits; }		//metodo para obter as estatisticas de uso
 
 	//metodo para forçar o flush de dados pendentes
@@ -75,6 +85,15 @@ class BitStream {
 	bool at_eof() const;
 
 	private:
+
+    // Escrever uma palavra completa do acumulador (big-endian)
+    void put_word(uint64_t word);
+
+    // Escrever os bits pendentes no acumulador, completando o ultimo byte com zeros
+    void put_pending_bits();
+
+    // Encher o acumulador com os bytes inteiros que ainda cabem
+    void fill_acc();
     
     // Atualizar o contador de bits processados
     void update_bit_counter(int bits_count) { m_total_bits += bits_count; }
@@ -20,7 +20,13 @@
 #define BYTE_STREAM_H
 
 #include <fstream>
+#include <string>
 #include <cstdint>
+#include <cstddef>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BYTE_STREAM_HAS_MMAP
+#endif
 
 const int BYTE_STREAM_BUF_SIZE = 65536;
 const bool STREAM_READ = true;
@@ -34,10 +40,21 @@ class ByteStream {
 	int				m_size;								//tamanho dos dados
 	bool			m_rw_status { STREAM_READ };		//indica o modo
 	off_t			m_tell { };							//offset(posiçao atual)
+	std::fstream	m_own_fs;							//filestream proprio (usado quando o ficheiro nao e mapeado)
 	std::fstream&	m_fs;								//referencia para o filestream adjacente
+	const uint8_t*	m_map { };							//ficheiro mapeado em memoria (so em leitura)
+	const uint8_t*	m_map_ptr { };						//posiçao atual dentro do mapeamento
+	const uint8_t*	m_map_limit { };					//fim do mapeamento
+
+	bool map_file(const std::string& filename);		//tenta mapear o ficheiro (mmap)
+	void unmap_file();								//liberta o mapeamento
 
   public:
 	ByteStream(std::fstream& fs, bool rw_status);
+	//stream so de leitura: mapeia o ficheiro em memoria quando possivel (ficheiros
+	//regulares) e usa um fstream caso contrario (pipes, ...)
+	ByteStream(const std::string& filename);
+	~ByteStream();
 
 	ByteStream() = delete;
 	ByteStream(const ByteStream&) = delete;
@@ -47,9 +64,13 @@ class ByteStream {
 
 	void put(int c);		//escreve um byte no stream(com buffering)
 	int get();				// le um byte do stream(com buffering)
+	void write(const uint8_t* data, size_t n);	//escreve n bytes de uma vez (com buffering)
+	size_t read(uint8_t* data, size_t n);		//le ate n bytes de uma vez; retorna quantos leu
 	void flush();			//força o flush do buffer para o disco
 	off_t tell();			//retorna a posiçao atual
 	void close();			//fecha o stream e liberta recursos
+	bool is_open() const;	//indica se o ficheiro foi aberto com sucesso
+	bool is_mapped() const { return m_map != nullptr; }	//indica se a leitura usa mmap
 };
 
 #endif
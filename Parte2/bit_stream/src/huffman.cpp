@@ -0,0 +1,201 @@
+//-------------------------------------------------------------------------------------------
+//
+// Huffman canónico - Implementação
+//
+//-------------------------------------------------------------------------------------------
+
+#include "huffman.h"
+#include <algorithm>
+
+using namespace std;
+
+//-------------------------------------------------------------------------------------------
+// Construção a partir do histograma
+//-------------------------------------------------------------------------------------------
+HuffmanCode HuffmanCode::from_histogram(const vector<uint64_t>& histogram, int max_bits) {
+    vector<uint8_t> lengths(histogram.size(), 0);
+
+    // Símbolos presentes, por frequência crescente
+    vector<uint32_t> used;
+    for (size_t s = 0; s < histogram.size(); s++) {
+        if (histogram[s] > 0) used.push_back(static_cast<uint32_t>(s));
+    }
+    stable_sort(used.begin(), used.end(), [&](uint32_t a, uint32_t b) {
+        return histogram[a] < histogram[b];
+    });
+
+    size_t m = used.size();
+    if (m == 1) {
+        lengths[used[0]] = 1;
+    } else if (m > 1) {
+        // Árvore de Huffman com duas filas (folhas ordenadas e nós internos, que
+        // são criados por ordem crescente de peso); pai sempre depois dos filhos
+        vector<uint64_t> weight(2 * m - 1);
+        vector<size_t> parent(2 * m - 1, 0);
+        for (size_t i = 0; i < m; i++) weight[i] = histogram[used[i]];
+
+        size_t next_leaf = 0;
+        size_t next_node = m;
+
+        for (size_t node = m; node < 2 * m - 1; node++) {
+            // Menor peso entre a próxima folha e o próximo nó interno já criado
+            // (os disponíveis são [next_node, node))
+            auto take_smallest = [&]() {
+                if (next_leaf < m && (next_node >= node || weight[next_leaf] <= weight[next_node])) {
+                    return next_leaf++;
+                }
+                return next_node++;
+            };
+            size_t a = take_smallest();
+            size_t b = take_smallest();
+
+            weight[node] = weight[a] + weight[b];
+            parent[a] = node;
+            parent[b] = node;
+        }
+
+        // Profundidade de cada nó, da raiz (último) para as folhas
+        vector<int> depth(2 * m - 1, 0);
+        for (size_t i = 2 * m - 1; i-- > 0;) {
+            if (i < 2 * m - 2) depth[i] = depth[parent[i]] + 1;
+        }
+
+        int max_depth = 0;
+        for (size_t i = 0; i < m; i++) max_depth = max(max_depth, depth[i]);
+
+        vector<int> bl_count(max(max_depth, max_bits) + 1, 0);
+        for (size_t i = 0; i < m; i++) bl_count[depth[i]]++;
+
+        // Limitar o comprimento (JPEG, anexo K.3): cada par de folhas demasiado
+        // profundas passa a ocupar o lugar de uma folha menos profunda
+        for (int i = max_depth; i > max_bits; i--) {
+            while (bl_count[i] > 0) {
+                int j = i - 2;
+                while (bl_count[j] == 0) j--;
+                bl_count[i] -= 2;
+                bl_count[i - 1] += 1;
+                bl_count[j + 1] += 2;
+                bl_count[j] -= 1;
+            }
+        }
+
+        // Códigos mais longos para os símbolos menos frequentes
+        size_t i = 0;
+        for (int len = max_bits; len >= 1; len--) {
+            for (int c = 0; c < bl_count[len]; c++) {
+                lengths[used[i++]] = static_cast<uint8_t>(len);
+            }
+        }
+    }
+
+    return from_lengths(lengths);
+}
+
+//-------------------------------------------------------------------------------------------
+// Construção a partir dos comprimentos
+//-------------------------------------------------------------------------------------------
+HuffmanCode HuffmanCode::from_lengths(const vector<uint8_t>& lengths) {
+    HuffmanCode code;
+    code.m_lengths = lengths;
+    code.build_codes();
+    if (code.m_valid) code.build_tables();
+    return code;
+}
+
+void HuffmanCode::build_codes() {
+    m_max_length = 0;
+    for (uint8_t len : m_lengths) {
+        if (len > HUFFMAN_MAX_BITS) {
+            m_valid = false;
+            return;
+        }
+        m_max_length = max<int>(m_max_length, len);
+    }
+
+    vector<uint32_t> bl_count(m_max_length + 1, 0);
+    for (uint8_t len : m_lengths) {
+        if (len > 0) bl_count[len]++;
+    }
+
+    // Desigualdade de Kraft: os códigos têm de caber na árvore
+    uint64_t kraft = 0;
+    for (int len = 1; len <= m_max_length; len++) {
+        kraft += static_cast<uint64_t>(bl_count[len]) << (m_max_length - len);
+    }
+    if (kraft > (uint64_t(1) << m_max_length)) {
+        m_valid = false;
+        return;
+    }
+
+    // Primeiro código de cada comprimento; dentro do mesmo comprimento os
+    // códigos seguem a ordem dos símbolos
+    vector<uint32_t> next_code(m_max_length + 1, 0);
+    uint32_t c = 0;
+    for (int len = 1; len <= m_max_length; len++) {
+        c = (c + bl_count[len - 1]) << 1;
+        next_code[len] = c;
+    }
+
+    m_codes.assign(m_lengths.size(), 0);
+    for (size_t s = 0; s < m_lengths.size(); s++) {
+        if (m_lengths[s] > 0) m_codes[s] = next_code[m_lengths[s]]++;
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// Tabelas de descodificação
+//-------------------------------------------------------------------------------------------
+void HuffmanCode::build_tables() {
+    m_root_bits = min(HUFFMAN_ROOT_BITS, m_max_length);
+
+    // Entradas sem código (só em códigos incompletos) consomem 1 bit
+    const Entry unused = { 0, 1, 0 };
+    m_table.assign(size_t(1) << m_root_bits, unused);
+
+    // Bits de índice de cada sub-tabela: o maior excesso sobre m_root_bits
+    // entre os códigos com esse prefixo
+    vector<uint8_t> sub_bits(m_table.size(), 0);
+    for (size_t s = 0; s < m_lengths.size(); s++) {
+        int len = m_lengths[s];
+        if (len > m_root_bits) {
+            uint32_t prefix = m_codes[s] >> (len - m_root_bits);
+            sub_bits[prefix] = max<uint8_t>(sub_bits[prefix], len - m_root_bits);
+        }
+    }
+
+    for (size_t prefix = 0; prefix < sub_bits.size(); prefix++) {
+        if (sub_bits[prefix] > 0) {
+            m_table[prefix] = { static_cast<uint32_t>(m_table.size()), 0, sub_bits[prefix] };
+            m_table.resize(m_table.size() + (size_t(1) << sub_bits[prefix]), unused);
+        }
+    }
+
+    for (size_t s = 0; s < m_lengths.size(); s++) {
+        int len = m_lengths[s];
+        if (len == 0) continue;
+
+        Entry entry = { static_cast<uint32_t>(s), static_cast<uint8_t>(len), 0 };
+        if (len <= m_root_bits) {
+            // Todas as entradas cujo índice começa pelo código
+            size_t first = size_t(m_codes[s]) << (m_root_bits - len);
+            fill_n(m_table.begin() + first, size_t(1) << (m_root_bits - len), entry);
+        } else {
+            int extra = len - m_root_bits;
+            const Entry& sub = m_table[m_codes[s] >> extra];
+            size_t low = m_codes[s] & ((1u << extra) - 1);
+            size_t first = sub.value + (low << (sub.sub_bits - extra));
+            fill_n(m_table.begin() + first, size_t(1) << (sub.sub_bits - extra), entry);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// Tamanho codificado
+//-------------------------------------------------------------------------------------------
+uint64_t HuffmanCode::encoded_bits(const vector<uint64_t>& histogram) const {
+    uint64_t bits = 0;
+    for (size_t s = 0; s < histogram.size() && s < m_lengths.size(); s++) {
+        bits += histogram[s] * m_lengths[s];
+    }
+    return bits;
+}
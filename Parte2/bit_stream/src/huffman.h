@@ -0,0 +1,125 @@
+//-------------------------------------------------------------------------------------------
+//
+// Huffman canónico
+//
+// O código é construído a partir de um histograma (com comprimento máximo limitado)
+// e fica totalmente definido pelos comprimentos de cada símbolo, que são a única
+// coisa guardada no ficheiro. A descodificação usa uma tabela de HUFFMAN_ROOT_BITS
+// bits indexada pelos próximos bits do stream (peek) e sub-tabelas para os códigos
+// mais longos, em vez de percorrer uma árvore bit a bit.
+//
+// Writer/Reader podem ser BitStream ou qualquer classe com write_n_bits ou
+// peek_n_bits/skip_n_bits/read_n_bits.
+//
+//-------------------------------------------------------------------------------------------
+
+#ifndef HUFFMAN_H
+#define HUFFMAN_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+const int HUFFMAN_MAX_BITS = 20;    // Maior comprimento de código
+const int HUFFMAN_ROOT_BITS = 10;   // Bits da tabela de primeiro nível
+const int HUFFMAN_SIZE_BITS = 24;   // Bits do tamanho do alfabeto no cabeçalho
+
+class HuffmanCode {
+private:
+    // Entrada das tabelas de descodificação
+    struct Entry {
+        uint32_t value;     // Símbolo, ou início da sub-tabela (length == 0)
+        uint8_t length;     // Bits do código (0 = aponta para uma sub-tabela)
+        uint8_t sub_bits;   // Bits de índice da sub-tabela
+    };
+
+    std::vector<uint8_t> m_lengths;     // Comprimento do código de cada símbolo (0 = ausente)
+    std::vector<uint32_t> m_codes;      // Código canónico de cada símbolo (MSB primeiro)
+    std::vector<Entry> m_table;         // Tabela de primeiro nível seguida das sub-tabelas
+    int m_max_length = 0;
+    int m_root_bits = 0;
+    bool m_valid = true;
+
+    void build_codes();
+    void build_tables();
+
+public:
+    HuffmanCode() = default;
+
+    /**
+     * @brief Código ótimo para um histograma, com comprimentos até max_bits
+     * @param histogram Número de ocorrências de cada símbolo (o alfabeto é 0 .. size-1)
+     */
+    static HuffmanCode from_histogram(const std::vector<uint64_t>& histogram,
+                                      int max_bits = HUFFMAN_MAX_BITS);
+
+    /**
+     * @brief Código canónico a partir dos comprimentos (is_valid() falso se não for prefixo)
+     */
+    static HuffmanCode from_lengths(const std::vector<uint8_t>& lengths);
+
+    bool is_valid() const { return m_valid; }
+    size_t num_symbols() const { return m_lengths.size(); }
+    int length(uint32_t symbol) const { return m_lengths[symbol]; }
+
+    /**
+     * @brief Número de bits para codificar o histograma com este código (sem tabela)
+     */
+    uint64_t encoded_bits(const std::vector<uint64_t>& histogram) const;
+
+    /**
+     * @brief Escreve o código: tamanho do alfabeto e comprimento de cada símbolo
+     *        (5 bits; um 0 é seguido de 8 bits com o número de zeros seguintes)
+     */
+    template <typename Writer>
+    void write_table(Writer& out) const {
+        size_t n = m_lengths.size();
+        out.write_n_bits(n, HUFFMAN_SIZE_BITS);
+        for (size_t i = 0; i < n; i++) {
+            out.write_n_bits(m_lengths[i], 5);
+            if (m_lengths[i] == 0) {
+                size_t run = 0;
+                while (run < 255 && i + 1 < n && m_lengths[i + 1] == 0) {
+                    run++;
+                    i++;
+                }
+                out.write_n_bits(run, 8);
+            }
+        }
+    }
+
+    template <typename Reader>
+    static HuffmanCode read_table(Reader& in) {
+        size_t n = in.read_n_bits(HUFFMAN_SIZE_BITS);
+        std::vector<uint8_t> lengths(n, 0);
+        for (size_t i = 0; i < n; i++) {
+            lengths[i] = static_cast<uint8_t>(in.read_n_bits(5));
+            if (lengths[i] == 0) {
+                i += in.read_n_bits(8);
+            }
+        }
+        return from_lengths(lengths);
+    }
+
+    template <typename Writer>
+    void encode(Writer& out, uint32_t symbol) const {
+        out.write_n_bits(m_codes[symbol], m_lengths[symbol]);
+    }
+
+    template <typename Reader>
+    uint32_t decode(Reader& in) const {
+        uint32_t bits = static_cast<uint32_t>(in.peek_n_bits(m_max_length));
+        const Entry* entry = &m_table[bits >> (m_max_length - m_root_bits)];
+
+        if (entry->length == 0) {
+            int rest = m_max_length - m_root_bits;
+            uint32_t index = (bits >> (rest - entry->sub_bits)) & ((1u << entry->sub_bits) - 1);
+            entry = &m_table[entry->value + index];
+        }
+
+        in.skip_n_bits(entry->length);
+        return entry->value;
+    }
+};
+
+#endif
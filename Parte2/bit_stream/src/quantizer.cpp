@@ -0,0 +1,209 @@
+//-------------------------------------------------------------------------------------------
+//
+// Quantização uniforme e Lloyd-Max - Implementação
+//
+//-------------------------------------------------------------------------------------------
+
+#include "quantizer.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+//-------------------------------------------------------------------------------------------
+// Arrays
+//-------------------------------------------------------------------------------------------
+
+template <int Bits>
+static void quantize_array(const short* samples, size_t count, uint16_t* levels) {
+    for (size_t i = 0; i < count; i++) {
+        levels[i] = UniformQuantizer<Bits>::quantize(samples[i]);
+    }
+}
+
+template <int Bits>
+static void dequantize_array(const uint16_t* levels, size_t count, short* samples) {
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = UniformQuantizer<Bits>::dequantize(levels[i]);
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// Seleção da versão para cada número de bits
+//-------------------------------------------------------------------------------------------
+
+using QuantizeFunction = void (*)(const short*, size_t, uint16_t*);
+using DequantizeFunction = void (*)(const uint16_t*, size_t, short*);
+
+static const QuantizeFunction quantize_functions[QUANT_MAX_BITS] = {
+    quantize_array<1>,  quantize_array<2>,  quantize_array<3>,  quantize_array<4>,
+    quantize_array<5>,  quantize_array<6>,  quantize_array<7>,  quantize_array<8>,
+    quantize_array<9>,  quantize_array<10>, quantize_array<11>, quantize_array<12>,
+    quantize_array<13>, quantize_array<14>, quantize_array<15>, quantize_array<16>
+};
+
+static const DequantizeFunction dequantize_functions[QUANT_MAX_BITS] = {
+    dequantize_array<1>,  dequantize_array<2>,  dequantize_array<3>,  dequantize_array<4>,
+    dequantize_array<5>,  dequantize_array<6>,  dequantize_array<7>,  dequantize_array<8>,
+    dequantize_array<9>,  dequantize_array<10>, dequantize_array<11>, dequantize_array<12>,
+    dequantize_array<13>, dequantize_array<14>, dequantize_array<15>, dequantize_array<16>
+};
+
+void quantize_samples(const short* samples, size_t count, int bits, uint16_t* levels) {
+    quantize_functions[bits - 1](samples, count, levels);
+}
+
+void dequantize_samples(const uint16_t* levels, size_t count, int bits, short* samples) {
+    dequantize_functions[bits - 1](levels, count, samples);
+}
+
+//-------------------------------------------------------------------------------------------
+// Lloyd-Max
+//-------------------------------------------------------------------------------------------
+
+// Erro quadrático total do codebook sobre o histograma (índice amostra + 32768)
+static double histogram_error(const LloydMaxCodebook& codebook, const vector<uint64_t>& histogram) {
+    vector<short> samples(65536);
+    for (int i = 0; i < 65536; i++) {
+        samples[i] = static_cast<short>(i - 32768);
+    }
+    vector<uint16_t> levels(samples.size());
+    vector<short> reconstructed(samples.size());
+    codebook.quantize(samples.data(), samples.size(), levels.data());
+    codebook.dequantize(levels.data(), levels.size(), reconstructed.data());
+
+    double error = 0.0;
+    for (int i = 0; i < 65536; i++) {
+        double e = static_cast<double>(samples[i]) - reconstructed[i];
+        error += histogram[i] * e * e;
+    }
+    return error;
+}
+
+LloydMaxCodebook LloydMaxCodebook::from_histogram(const vector<uint64_t>& histogram, int bits,
+                                                  int max_iterations) {
+    const int num_values = 65536;
+    const size_t num_levels = size_t(1) << bits;
+
+    // Somas acumuladas: count[i] e sum[i] das amostras com índice < i
+    vector<uint64_t> count(num_values + 1, 0);
+    vector<double> sum(num_values + 1, 0.0);
+    vector<int> distinct;
+    for (int i = 0; i < num_values; i++) {
+        count[i + 1] = count[i] + histogram[i];
+        sum[i + 1] = sum[i] + static_cast<double>(histogram[i]) * i;
+        if (histogram[i] > 0) distinct.push_back(i);
+    }
+    uint64_t total = count[num_values];
+
+    if (distinct.size() <= num_levels) {
+        // Cada valor presente tem o seu nível (o resto repete o último)
+        vector<short> result;
+        for (int i : distinct) {
+            result.push_back(static_cast<short>(i - 32768));
+        }
+        result.resize(num_levels, result.empty() ? 0 : result.back());
+        return from_levels(result);
+    }
+
+    // Centróide das amostras com índice em [lo, hi), ou fallback se não houver nenhuma
+    auto centroid = [&](int lo, int hi, double fallback) {
+        uint64_t n = count[hi] - count[lo];
+        return n > 0 ? (sum[hi] - sum[lo]) / static_cast<double>(n) : fallback;
+    };
+
+    // Lloyd: fronteiras a meio dos níveis, níveis nos centróides (células vazias mantêm o nível)
+    auto refine = [&](vector<double> levels) {
+        vector<int> bounds(num_levels + 1);
+        bounds[0] = 0;
+        bounds[num_levels] = num_values;
+        for (int iteration = 0; iteration < max_iterations; iteration++) {
+            for (size_t k = 1; k < num_levels; k++) {
+                bounds[k] = static_cast<int>(floor(0.5 * (levels[k - 1] + levels[k]))) + 1;
+                bounds[k] = min(max(bounds[k], bounds[k - 1]), num_values);
+            }
+
+            double change = 0.0;
+            for (size_t k = 0; k < num_levels; k++) {
+                double level = centroid(bounds[k], bounds[k + 1], levels[k]);
+                change = max(change, fabs(level - levels[k]));
+                levels[k] = level;
+            }
+            if (change < 0.01) break;
+        }
+
+        vector<short> rounded(num_levels);
+        for (size_t k = 0; k < num_levels; k++) {
+            rounded[k] = static_cast<short>(lround(levels[k]) - 32768);
+        }
+        sort(rounded.begin(), rounded.end());
+        return from_levels(rounded);
+    };
+
+    // Início nos quantis: células com o mesmo número de amostras; um valor com muitas
+    // ocorrências pode ocupar várias, pelo que os limites são forçados a crescer
+    vector<int> bounds(num_levels + 1);
+    bounds[0] = distinct.front();
+    bounds[num_levels] = distinct.back() + 1;
+    for (size_t k = 1; k < num_levels; k++) {
+        uint64_t target = total * k / num_levels;
+        int b = static_cast<int>(upper_bound(count.begin(), count.end(), target) - count.begin()) - 1;
+        bounds[k] = max(b, bounds[k - 1] + 1);
+    }
+    for (size_t k = num_levels; k-- > 1; ) {
+        bounds[k] = min(bounds[k], bounds[k + 1] - 1);
+    }
+
+    vector<double> quantile_levels(num_levels);
+    for (size_t k = 0; k < num_levels; k++) {
+        quantile_levels[k] = centroid(bounds[k], bounds[k + 1], 0.5 * (bounds[k] + bounds[k + 1] - 1));
+    }
+
+    // Início nos níveis uniformes: com muitos níveis e caudas esparsas os quantis
+    // convergem para um mínimo pior que a quantização uniforme, de onde este parte
+    double step = static_cast<double>(num_values) / num_levels;
+    vector<double> uniform_levels(num_levels);
+    for (size_t k = 0; k < num_levels; k++) {
+        uniform_levels[k] = (k + 0.5) * step;
+    }
+
+    LloydMaxCodebook from_quantiles = refine(quantile_levels);
+    LloydMaxCodebook from_uniform = refine(uniform_levels);
+    return histogram_error(from_quantiles, histogram) <= histogram_error(from_uniform, histogram)
+               ? from_quantiles : from_uniform;
+}
+
+LloydMaxCodebook LloydMaxCodebook::from_levels(const vector<short>& levels) {
+    LloydMaxCodebook codebook;
+    codebook.m_levels = levels;
+    if (!levels.empty() && is_sorted(levels.begin(), levels.end())) {
+        codebook.build_table();
+    }
+    return codebook;
+}
+
+void LloydMaxCodebook::build_table() {
+    // Os níveis são crescentes: o mais próximo só avança com a amostra
+    m_table.resize(65536);
+    size_t k = 0;
+    for (int x = -32768; x <= 32767; x++) {
+        while (k + 1 < m_levels.size() && abs(m_levels[k + 1] - x) < abs(x - m_levels[k])) {
+            k++;
+        }
+        m_table[x + 32768] = static_cast<uint16_t>(k);
+    }
+}
+
+void LloydMaxCodebook::quantize(const short* samples, size_t count, uint16_t* levels) const {
+    for (size_t i = 0; i < count; i++) {
+        levels[i] = m_table[static_cast<uint16_t>(samples[i]) ^ 0x8000];
+    }
+}
+
+void LloydMaxCodebook::dequantize(const uint16_t* levels, size_t count, short* samples) const {
+    // Índices fora da tabela (ficheiro corrompido) ficam no último nível
+    size_t last = m_levels.size() - 1;
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = m_levels[min<size_t>(levels[i], last)];
+    }
+}
@@ -0,0 +1,130 @@
+//-------------------------------------------------------------------------------------------
+//
+// Quantização uniforme de amostras de 16 bits para 1 a 16 bits
+//
+// O passo é 2^(16 - bits), pelo que a quantização e a reconstrução (no centro do
+// intervalo) são deslocamentos em aritmética de 16 bits, sem vírgula flutuante. Há
+// uma versão para cada número de bits (template), escolhida uma vez por ficheiro; os
+// ciclos sobre arrays são vetorizados pelo compilador. O resultado é idêntico ao das
+// fórmulas em double usadas antes por WAVQuantEnc/WAVQuantDec (verificado para todas
+// as amostras e níveis pelo quantizer_bench).
+//
+// LloydMaxCodebook é a alternativa não uniforme: níveis de reconstrução treinados no
+// histograma das amostras do ficheiro, guardados no ficheiro como tabela.
+//
+//-------------------------------------------------------------------------------------------
+
+#ifndef QUANTIZER_H
+#define QUANTIZER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+const int QUANT_MAX_BITS = 16;
+const int LLOYD_MAX_ITERATIONS = 500;   // Iterações de Lloyd no treino (no máximo)
+const double LLOYD_MIN_GAIN_DB = 0.1;   // Ganho de SNR mínimo para usar o codebook no ficheiro
+
+/**
+ * @brief Quantizador uniforme para um número de bits fixo
+ *
+ * Com 16 bits o nível é a própria amostra (em complemento para 2).
+ */
+template <int Bits>
+struct UniformQuantizer {
+    static_assert(Bits >= 1 && Bits <= QUANT_MAX_BITS);
+
+    static constexpr int shift = 16 - Bits;
+
+    // Nível (0 a 2^Bits - 1): (amostra + 32768) / passo, com a soma feita invertendo
+    // o bit de sinal
+    static uint16_t quantize(short sample) {
+        if constexpr (Bits == 16) {
+            return static_cast<uint16_t>(sample);
+        } else {
+            return static_cast<uint16_t>((static_cast<uint16_t>(sample) ^ 0x8000) >> shift);
+        }
+    }
+
+    // Centro do intervalo: nível * passo + passo / 2 - 32768
+    static short dequantize(uint16_t level) {
+        if constexpr (Bits == 16) {
+            return static_cast<short>(level);
+        } else {
+            return static_cast<short>(static_cast<uint16_t>((level << shift) + (1 << (shift - 1))) ^ 0x8000);
+        }
+    }
+};
+
+/**
+ * @brief Quantiza count amostras para níveis de bits bits (1 a 16)
+ */
+void quantize_samples(const short* samples, size_t count, int bits, uint16_t* levels);
+
+/**
+ * @brief Reconstrói count amostras a partir dos níveis de bits bits (1 a 16)
+ */
+void dequantize_samples(const uint16_t* levels, size_t count, int bits, short* samples);
+
+/**
+ * @brief Quantizador não uniforme com 2^bits níveis de reconstrução (Lloyd-Max)
+ *
+ * Os níveis, por ordem crescente, minimizam o erro quadrático médio para um
+ * histograma das amostras: são refinados com o algoritmo de Lloyd (fronteiras a meio
+ * dos níveis, níveis nos centróides das células), com somas acumuladas do histograma
+ * para cada iteração custar O(níveis), a partir dos quantis e a partir dos níveis
+ * uniformes, ficando o de menor erro (nunca pior que o uniforme, a menos do
+ * arredondamento dos níveis a inteiros).
+ * Se o histograma tiver no máximo 2^bits valores distintos, os níveis são esses
+ * valores e a quantização não tem perdas. A quantização usa uma tabela com o nível
+ * mais próximo de cada uma das 65536 amostras possíveis (O(1) por amostra).
+ */
+class LloydMaxCodebook {
+private:
+    std::vector<short> m_levels;    // Níveis de reconstrução (crescentes)
+    std::vector<uint16_t> m_table;  // Índice do nível mais próximo de cada amostra + 32768
+
+    void build_table();
+
+public:
+    LloydMaxCodebook() = default;
+
+    /**
+     * @brief Treina os níveis para um histograma
+     * @param histogram 65536 contagens, índice amostra + 32768
+     */
+    static LloydMaxCodebook from_histogram(const std::vector<uint64_t>& histogram, int bits,
+                                           int max_iterations = LLOYD_MAX_ITERATIONS);
+
+    /**
+     * @brief Codebook com os níveis dados (is_valid() falso se não forem crescentes)
+     */
+    static LloydMaxCodebook from_levels(const std::vector<short>& levels);
+
+    bool is_valid() const { return !m_table.empty(); }
+    const std::vector<short>& levels() const { return m_levels; }
+
+    void quantize(const short* samples, size_t count, uint16_t* levels) const;
+    void dequantize(const uint16_t* levels, size_t count, short* samples) const;
+
+    /**
+     * @brief Escreve os níveis (16 bits cada; o número é dado pelos bits do header)
+     */
+    template <typename Writer>
+    void write_table(Writer& out) const {
+        for (short level : m_levels) {
+            out.write_n_bits(static_cast<uint16_t>(level), 16);
+        }
+    }
+
+    template <typename Reader>
+    static LloydMaxCodebook read_table(Reader& in, int bits) {
+        std::vector<short> levels(size_t(1) << bits);
+        for (auto& level : levels) {
+            level = static_cast<short>(in.read_n_bits(16));
+        }
+        return from_levels(levels);
+    }
+};
+
+#endif
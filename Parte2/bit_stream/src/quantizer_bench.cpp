@@ -0,0 +1,247 @@
+//-------------------------------------------------------------------------------------------
+//
+// Quantizer Benchmark - Quantizadores inteiros contra as fórmulas em double
+//
+// Para cada número de bits compara quantize_samples com a fórmula original para as
+// 65536 amostras possíveis e dequantize_samples para todos os níveis, e mede o débito
+// das duas versões em MB/s de amostras de 16 bits. Para o LloydMaxCodebook, treinado
+// num sinal de teste, compara a tabela com a procura do nível mais próximo e mede o
+// débito da quantização por tabela e a SNR contra a quantização uniforme.
+//
+//-------------------------------------------------------------------------------------------
+
+#include "quantizer.h"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+/**
+ * @brief Quantização original de WAVQuantEnc (passo em double)
+ */
+uint16_t reference_quantize(short sample, int bits) {
+    if (bits >= 16) return static_cast<uint16_t>(sample);
+
+    int num_levels = 1 << bits;
+    double step = 65536.0 / num_levels;
+    int quantized = static_cast<int>((sample + 32768.0) / step);
+    if (quantized >= num_levels) quantized = num_levels - 1;
+    if (quantized < 0) quantized = 0;
+    return static_cast<uint16_t>(quantized);
+}
+
+/**
+ * @brief Reconstrução original de WAVQuantDec (centro do intervalo, em double)
+ */
+short reference_dequantize(int level, int bits) {
+    if (bits >= 16) return static_cast<short>(level);
+
+    int num_levels = 1 << bits;
+    double step = 65536.0 / num_levels;
+    double reconstructed = level * step - 32768.0 + step / 2.0;
+    if (reconstructed > 32767.0) reconstructed = 32767.0;
+    if (reconstructed < -32768.0) reconstructed = -32768.0;
+    return static_cast<short>(reconstructed);
+}
+
+/**
+ * @brief Sinal pseudo-aleatório de 16 bits (uniforme)
+ */
+vector<short> make_samples(size_t count) {
+    vector<short> samples(count);
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (auto& s : samples) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        s = static_cast<short>(x >> 48);
+    }
+    return samples;
+}
+
+/**
+ * @brief Sinal pseudo-aleatório com distribuição aproximadamente laplaciana, como o áudio
+ */
+vector<short> make_laplacian_samples(size_t count) {
+    vector<short> samples(count);
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (auto& s : samples) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        double u = (static_cast<double>(x >> 11) + 0.5) / 9007199254740992.0;
+        double v = (u < 0.5) ? 2000.0 * log(2.0 * u) : -2000.0 * log(2.0 * (1.0 - u));
+        s = static_cast<short>(max(-32768.0, min(32767.0, v)));
+    }
+    return samples;
+}
+
+double snr(const vector<short>& original, const vector<short>& reconstructed) {
+    double signal = 0.0, noise = 0.0;
+    for (size_t i = 0; i < original.size(); i++) {
+        double error = static_cast<double>(original[i]) - reconstructed[i];
+        signal += static_cast<double>(original[i]) * original[i];
+        noise += error * error;
+    }
+    return noise > 0.0 ? 10.0 * log10(signal / noise) : INFINITY;
+}
+
+double seconds_since(chrono::high_resolution_clock::time_point start) {
+    return chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+}
+
+/**
+ * @brief Verificação exaustiva e débito para um número de bits
+ * @return true se todas as amostras e níveis coincidirem com as fórmulas originais
+ */
+bool bench_bits(int bits, const vector<short>& samples) {
+    // Todas as amostras e todos os níveis
+    vector<short> all_samples(65536);
+    for (int i = 0; i < 65536; i++) {
+        all_samples[i] = static_cast<short>(i - 32768);
+    }
+    vector<uint16_t> all_levels(size_t(1) << bits);
+    for (size_t i = 0; i < all_levels.size(); i++) {
+        all_levels[i] = static_cast<uint16_t>(i);
+    }
+
+    vector<uint16_t> levels(all_samples.size());
+    quantize_samples(all_samples.data(), all_samples.size(), bits, levels.data());
+    vector<short> reconstructed(all_levels.size());
+    dequantize_samples(all_levels.data(), all_levels.size(), bits, reconstructed.data());
+
+    bool ok = true;
+    for (size_t i = 0; i < all_samples.size(); i++) {
+        ok = ok && levels[i] == reference_quantize(all_samples[i], bits);
+    }
+    for (size_t i = 0; i < all_levels.size(); i++) {
+        ok = ok && reconstructed[i] == reference_dequantize(all_levels[i], bits);
+    }
+
+    // Débito: amostra a amostra em double e em bloco
+    size_t count = samples.size();
+    vector<uint16_t> quantized(count);
+    vector<short> output(count);
+
+    auto start = chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < count; i++) {
+        quantized[i] = reference_quantize(samples[i], bits);
+    }
+    double reference_quant_time = seconds_since(start);
+
+    start = chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < count; i++) {
+        output[i] = reference_dequantize(quantized[i], bits);
+    }
+    double reference_dequant_time = seconds_since(start);
+
+    start = chrono::high_resolution_clock::now();
+    quantize_samples(samples.data(), count, bits, quantized.data());
+    double quant_time = seconds_since(start);
+
+    start = chrono::high_resolution_clock::now();
+    dequantize_samples(quantized.data(), count, bits, output.data());
+    double dequant_time = seconds_since(start);
+
+    double megabytes = 2.0 * count / 1e6;
+    cout << setw(6) << bits
+         << setw(12) << setprecision(0) << megabytes / reference_quant_time
+         << setw(12) << megabytes / reference_dequant_time
+         << setw(12) << megabytes / quant_time
+         << setw(12) << megabytes / dequant_time
+         << setw(8) << (ok ? "OK" : "ERRO") << endl;
+
+    return ok;
+}
+
+/**
+ * @brief Codebook treinado para um número de bits: tabela e débito
+ * @return true se a tabela der sempre o nível mais próximo
+ */
+bool bench_lloyd(int bits, const vector<short>& samples) {
+    vector<uint64_t> histogram(65536, 0);
+    for (short s : samples) {
+        histogram[static_cast<uint16_t>(s) ^ 0x8000]++;
+    }
+
+    auto start = chrono::high_resolution_clock::now();
+    LloydMaxCodebook codebook = LloydMaxCodebook::from_histogram(histogram, bits);
+    double train_time = seconds_since(start);
+
+    // Tabela contra a procura do nível mais próximo em todos os níveis
+    const vector<short>& levels = codebook.levels();
+    vector<short> all_samples(65536);
+    for (int i = 0; i < 65536; i++) {
+        all_samples[i] = static_cast<short>(i - 32768);
+    }
+    vector<uint16_t> table(all_samples.size());
+    codebook.quantize(all_samples.data(), all_samples.size(), table.data());
+
+    bool ok = codebook.is_valid() && is_sorted(levels.begin(), levels.end());
+    for (size_t i = 0; i < all_samples.size() && ok; i++) {
+        int best = abs(all_samples[i] - levels[0]);
+        for (short level : levels) {
+            best = min(best, abs(all_samples[i] - level));
+        }
+        ok = abs(all_samples[i] - levels[table[i]]) == best;
+    }
+
+    size_t count = samples.size();
+    vector<uint16_t> quantized(count);
+    vector<short> output(count), uniform_output(count);
+
+    start = chrono::high_resolution_clock::now();
+    codebook.quantize(samples.data(), count, quantized.data());
+    double quant_time = seconds_since(start);
+
+    start = chrono::high_resolution_clock::now();
+    codebook.dequantize(quantized.data(), count, output.data());
+    double dequant_time = seconds_since(start);
+
+    quantize_samples(samples.data(), count, bits, quantized.data());
+    dequantize_samples(quantized.data(), count, bits, uniform_output.data());
+
+    double megabytes = 2.0 * count / 1e6;
+    cout << setw(6) << bits
+         << setw(12) << setprecision(1) << train_time * 1e3
+         << setw(12) << setprecision(0) << megabytes / quant_time
+         << setw(12) << megabytes / dequant_time
+         << setw(12) << setprecision(2) << snr(samples, uniform_output)
+         << setw(12) << snr(samples, output)
+         << setw(8) << (ok ? "OK" : "ERRO") << endl;
+
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    // Amostras por teste (default: 10 minutos de áudio estéreo a 44.1 kHz)
+    size_t count = (argc > 1) ? strtoull(argv[1], nullptr, 10) : size_t(44100) * 600 * 2;
+    vector<short> samples = make_samples(count);
+
+    cout << "Quantizer Benchmark" << endl;
+    cout << "===================" << endl;
+    cout << fixed;
+    cout << setw(6) << "Bits" << setw(12) << "Q ref MB/s" << setw(12) << "D ref MB/s"
+         << setw(12) << "Quant MB/s" << setw(12) << "Dequant MB/s" << setw(8) << "Check" << endl;
+
+    bool ok = true;
+    for (int bits = 1; bits <= QUANT_MAX_BITS; bits++) {
+        ok = bench_bits(bits, samples) && ok;
+    }
+
+    vector<short> laplacian = make_laplacian_samples(count);
+    cout << endl << "Lloyd-Max (sinal laplaciano)" << endl;
+    cout << setw(6) << "Bits" << setw(12) << "Treino ms" << setw(12) << "Quant MB/s"
+         << setw(12) << "Dequant MB/s" << setw(12) << "SNR unif." << setw(12) << "SNR Lloyd"
+         << setw(8) << "Check" << endl;
+    for (int bits = 1; bits <= QUANT_MAX_BITS; bits++) {
+        ok = bench_lloyd(bits, laplacian) && ok;
+    }
+
+    return ok ? 0 : 1;
+}
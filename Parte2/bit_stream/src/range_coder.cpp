@@ -0,0 +1,94 @@
+//-------------------------------------------------------------------------------------------
+//
+// Range coder - Implementação
+//
+//-------------------------------------------------------------------------------------------
+
+#include "range_coder.h"
+#include <algorithm>
+
+using namespace std;
+
+//-------------------------------------------------------------------------------------------
+// Codificador / descodificador
+//-------------------------------------------------------------------------------------------
+void RangeEncoder::flush() {
+    // 5 bytes: o cache pendente mais os 4 bytes de m_low
+    for (int i = 0; i < 5; i++) {
+        shift_low();
+    }
+}
+
+RangeDecoder::RangeDecoder(ByteStream& bs) : m_bs(bs) {
+    // O primeiro byte do codificador é sempre 0 (cache inicial)
+    for (int i = 0; i < 5; i++) {
+        m_code = (m_code << 8) | next_byte();
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// Modelo de amostras
+//-------------------------------------------------------------------------------------------
+static int bit_length(uint32_t m) {
+    int n = 0;
+    while (m > 0) {
+        n++;
+        m >>= 1;
+    }
+    return n;
+}
+
+SampleModel::SampleModel(int bits, int channels)
+    : m_channels(channels),
+      m_prev(channels, 1 << (bits - 1)), m_prev_category(channels, 0) {
+    // Resíduos de -(2^bits - 1) a 2^bits - 1: categorias de 0 a bits + 1
+    int num_categories = bits + 2;
+    int category_bits = bit_length(num_categories - 1);
+
+    m_category.assign(num_categories, BitTree(category_bits));
+    for (int c = 0; c < num_categories; c++) {
+        m_high.emplace_back(min(max(c - 1, 0), SAMPLE_MODEL_HIGH_BITS));
+    }
+}
+
+void SampleModel::encode(RangeEncoder& rc, int sample) {
+    int residual = sample - m_prev[m_channel];
+    uint32_t m = (static_cast<uint32_t>(residual) << 1) ^ static_cast<uint32_t>(residual >> 31);
+    int category = bit_length(m);
+
+    m_category[m_prev_category[m_channel]].encode(rc, category);
+    if (category > 1) {
+        // Bits abaixo do mais significativo: os de cima com modelo, o resto direto
+        int rest = category - 1;
+        int high = min(rest, SAMPLE_MODEL_HIGH_BITS);
+        m_high[category].encode(rc, (m >> (rest - high)) & ((1u << high) - 1));
+        rc.encode_direct(m, rest - high);
+    }
+
+    m_prev[m_channel] = sample;
+    m_prev_category[m_channel] = category;
+    m_channel = (m_channel + 1 == m_channels) ? 0 : m_channel + 1;
+}
+
+int SampleModel::decode(RangeDecoder& rc) {
+    int category = static_cast<int>(m_category[m_prev_category[m_channel]].decode(rc));
+
+    // Ficheiro corrompido: a árvore pode dar categorias fora do alfabeto
+    category = min(category, static_cast<int>(m_high.size()) - 1);
+
+    uint32_t m = static_cast<uint32_t>(category);
+    if (category > 1) {
+        int rest = category - 1;
+        int high = min(rest, SAMPLE_MODEL_HIGH_BITS);
+        m = (1u << high) | m_high[category].decode(rc);
+        m = (m << (rest - high)) | rc.decode_direct(rest - high);
+    }
+
+    int residual = static_cast<int>(m >> 1) ^ -static_cast<int>(m & 1);
+    int sample = m_prev[m_channel] + residual;
+
+    m_prev[m_channel] = sample;
+    m_prev_category[m_channel] = category;
+    m_channel = (m_channel + 1 == m_channels) ? 0 : m_channel + 1;
+    return sample;
+}
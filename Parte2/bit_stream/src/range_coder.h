@@ -0,0 +1,210 @@
+//-------------------------------------------------------------------------------------------
+//
+// Codificador aritmético binário (range coder) com modelos adaptativos
+//
+// Variante do range coder do LZMA: cada decisão binária é codificada com uma
+// probabilidade de RC_PROB_BITS bits, que se adapta depois de cada bit (média
+// exponencial com passo 2^-RC_MOVE_BITS), pelo que símbolos muito prováveis custam
+// uma fração de bit. O código é escrito byte a byte diretamente num ByteStream,
+// como alternativa ao BitStream.
+//
+// Símbolos de vários bits usam uma árvore binária de probabilidades (BitTree);
+// SampleModel junta os modelos usados para amostras de áudio quantizadas.
+//
+//-------------------------------------------------------------------------------------------
+
+#ifndef RANGE_CODER_H
+#define RANGE_CODER_H
+
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include "byte_stream.h"
+
+const int RC_PROB_BITS = 11;                        // Precisão das probabilidades
+const uint16_t RC_PROB_INIT = 1 << (RC_PROB_BITS - 1);  // p(0) = 1/2
+const int RC_MOVE_BITS = 5;                         // Velocidade de adaptação
+const uint32_t RC_TOP = 1u << 24;                   // Limite para renormalizar
+
+class RangeEncoder {
+private:
+    ByteStream& m_bs;
+    uint64_t m_low = 0;
+    uint32_t m_range = 0xFFFFFFFF;
+    uint8_t m_cache = 0;            // Último byte ainda sujeito a carry
+    uint64_t m_cache_size = 1;      // Bytes pendentes (o cache e os 0xFF seguintes)
+    uint64_t m_bytes = 0;
+
+    // Envia o byte de topo de m_low, propagando o carry aos bytes pendentes
+    void shift_low() {
+        if (static_cast<uint32_t>(m_low) < 0xFF000000u || (m_low >> 32) != 0) {
+            uint8_t carry = static_cast<uint8_t>(m_low >> 32);
+            uint8_t byte = m_cache;
+            do {
+                m_bs.put(static_cast<uint8_t>(byte + carry));
+                m_bytes++;
+                byte = 0xFF;
+            } while (--m_cache_size != 0);
+            m_cache = static_cast<uint8_t>(m_low >> 24);
+        }
+        m_cache_size++;
+        m_low = (m_low & 0x00FFFFFF) << 8;
+    }
+
+public:
+    explicit RangeEncoder(ByteStream& bs) : m_bs(bs) {}
+
+    /**
+     * @brief Codifica um bit com a probabilidade prob (de ser 0), que é atualizada
+     */
+    void encode_bit(uint16_t& prob, int bit) {
+        uint32_t bound = (m_range >> RC_PROB_BITS) * prob;
+        if (bit == 0) {
+            m_range = bound;
+            prob += ((1 << RC_PROB_BITS) - prob) >> RC_MOVE_BITS;
+        } else {
+            m_low += bound;
+            m_range -= bound;
+            prob -= prob >> RC_MOVE_BITS;
+        }
+        while (m_range < RC_TOP) {
+            m_range <<= 8;
+            shift_low();
+        }
+    }
+
+    /**
+     * @brief Codifica os n bits menos significativos de value com probabilidade 1/2
+     */
+    void encode_direct(uint32_t value, int n) {
+        while (n-- > 0) {
+            m_range >>= 1;
+            if ((value >> n) & 1) m_low += m_range;
+            while (m_range < RC_TOP) {
+                m_range <<= 8;
+                shift_low();
+            }
+        }
+    }
+
+    /**
+     * @brief Escreve os bytes que faltam para o descodificador (chamar uma vez no fim)
+     */
+    void flush();
+
+    uint64_t bytes_written() const { return m_bytes; }
+};
+
+class RangeDecoder {
+private:
+    ByteStream& m_bs;
+    uint32_t m_range = 0xFFFFFFFF;
+    uint32_t m_code = 0;
+
+    uint32_t next_byte() {
+        int c = m_bs.get();
+        return (c == EOF) ? 0 : static_cast<uint32_t>(c);
+    }
+
+public:
+    /**
+     * @brief Começa a descodificar na posição atual do ByteStream
+     */
+    explicit RangeDecoder(ByteStream& bs);
+
+    int decode_bit(uint16_t& prob) {
+        uint32_t bound = (m_range >> RC_PROB_BITS) * prob;
+        int bit;
+        if (m_code < bound) {
+            m_range = bound;
+            prob += ((1 << RC_PROB_BITS) - prob) >> RC_MOVE_BITS;
+            bit = 0;
+        } else {
+            m_code -= bound;
+            m_range -= bound;
+            prob -= prob >> RC_MOVE_BITS;
+            bit = 1;
+        }
+        while (m_range < RC_TOP) {
+            m_range <<= 8;
+            m_code = (m_code << 8) | next_byte();
+        }
+        return bit;
+    }
+
+    uint32_t decode_direct(int n) {
+        uint32_t value = 0;
+        while (n-- > 0) {
+            m_range >>= 1;
+            uint32_t bit = (m_code >= m_range) ? 1 : 0;
+            if (bit) m_code -= m_range;
+            value = (value << 1) | bit;
+            while (m_range < RC_TOP) {
+                m_range <<= 8;
+                m_code = (m_code << 8) | next_byte();
+            }
+        }
+        return value;
+    }
+};
+
+/**
+ * @brief Símbolo de num_bits bits codificado bit a bit (MSB primeiro), com uma
+ *        probabilidade por prefixo já visto
+ */
+class BitTree {
+private:
+    std::vector<uint16_t> m_probs;
+    int m_num_bits;
+
+public:
+    explicit BitTree(int num_bits)
+        : m_probs(size_t(1) << num_bits, RC_PROB_INIT), m_num_bits(num_bits) {}
+
+    void encode(RangeEncoder& rc, uint32_t symbol) {
+        uint32_t node = 1;
+        for (int i = m_num_bits - 1; i >= 0; i--) {
+            int bit = (symbol >> i) & 1;
+            rc.encode_bit(m_probs[node], bit);
+            node = (node << 1) | bit;
+        }
+    }
+
+    uint32_t decode(RangeDecoder& rc) {
+        uint32_t node = 1;
+        for (int i = 0; i < m_num_bits; i++) {
+            node = (node << 1) | rc.decode_bit(m_probs[node]);
+        }
+        return node - (1u << m_num_bits);
+    }
+};
+
+const int SAMPLE_MODEL_HIGH_BITS = 3;    // Bits do resíduo (abaixo do MSB) com modelo
+
+/**
+ * @brief Modelo para amostras quantizadas (níveis 0 .. 2^bits - 1)
+ *
+ * Cada amostra é prevista pela anterior do mesmo canal e o resíduo, mapeado por
+ * zigzag, é codificado como categoria (número de bits) seguida dos bits abaixo do
+ * mais significativo. A categoria usa como contexto a categoria anterior do canal,
+ * e os SAMPLE_MODEL_HIGH_BITS bits seguintes um modelo por categoria; os restantes
+ * vão com probabilidade 1/2. Codificador e descodificador têm de usar modelos
+ * construídos com os mesmos parâmetros.
+ */
+class SampleModel {
+private:
+    int m_channels;
+    std::vector<BitTree> m_category;    // Uma árvore por categoria anterior
+    std::vector<BitTree> m_high;        // Uma árvore por categoria
+    std::vector<int> m_prev;            // Última amostra de cada canal
+    std::vector<int> m_prev_category;   // Última categoria de cada canal
+    int m_channel = 0;                  // Canal da próxima amostra (intercaladas)
+
+public:
+    SampleModel(int bits, int channels);
+
+    void encode(RangeEncoder& rc, int sample);
+    int decode(RangeDecoder& rc);
+};
+
+#endif
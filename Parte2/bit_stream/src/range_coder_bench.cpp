@@ -0,0 +1,119 @@
+//-------------------------------------------------------------------------------------------
+//
+// Range Coder Benchmark - Débito e taxa do SampleModel sobre amostras quantizadas
+//
+//-------------------------------------------------------------------------------------------
+
+#include "range_coder.h"
+#include "byte_stream.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+
+using namespace std;
+
+/**
+ * @brief Sinal estéreo sintético (tons + ruído) quantizado como no WAVQuantEnc
+ */
+vector<int> make_signal(size_t frames, int bits) {
+    vector<int> samples(frames * 2);
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    int num_levels = 1 << bits;
+    double step = 65536.0 / num_levels;
+
+    for (size_t i = 0; i < frames; i++) {
+        for (int c = 0; c < 2; c++) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            double noise = (static_cast<double>(x >> 11) / 9007199254740992.0 - 0.5) * 400.0;
+            double t = static_cast<double>(i) / 44100.0;
+            double s = 8000.0 * sin(2 * M_PI * 440.0 * t + c) + 3000.0 * sin(2 * M_PI * 3150.0 * t) + noise;
+
+            int q = static_cast<int>((s + 32768.0) / step);
+            samples[i * 2 + c] = max(0, min(num_levels - 1, q));
+        }
+    }
+    return samples;
+}
+
+/**
+ * @brief Codifica e descodifica as amostras, medindo o débito
+ * @return true se as amostras descodificadas coincidirem com as originais
+ */
+bool bench_bits(int bits, size_t frames, const string& tmp_file) {
+    vector<int> samples = make_signal(frames, bits);
+
+    auto start_encode = chrono::high_resolution_clock::now();
+    uint64_t bytes;
+    {
+        fstream ofs(tmp_file, ios::out | ios::binary);
+        ByteStream obs(ofs, STREAM_WRITE);
+        RangeEncoder rc(obs);
+        SampleModel model(bits, 2);
+        for (int s : samples) {
+            model.encode(rc, s);
+        }
+        rc.flush();
+        bytes = rc.bytes_written();
+        obs.close();
+    }
+    auto end_encode = chrono::high_resolution_clock::now();
+
+    bool ok = true;
+    auto start_decode = chrono::high_resolution_clock::now();
+    {
+        ByteStream ibs(tmp_file);
+        RangeDecoder rc(ibs);
+        SampleModel model(bits, 2);
+        for (int s : samples) {
+            if (model.decode(rc) != s) {
+                ok = false;
+            }
+        }
+        ibs.close();
+    }
+    auto end_decode = chrono::high_resolution_clock::now();
+
+    double encode_time = chrono::duration<double>(end_encode - start_encode).count();
+    double decode_time = chrono::duration<double>(end_decode - start_decode).count();
+    double bits_per_sample = 8.0 * bytes / samples.size();
+
+    // MB/s e tempo real medidos sobre o áudio original (16 bits, 44.1 kHz estéreo)
+    double megabytes = 2.0 * samples.size() / 1e6;
+    double audio_seconds = static_cast<double>(frames) / 44100.0;
+
+    cout << setw(6) << bits
+         << setw(12) << setprecision(2) << bits_per_sample
+         << setw(12) << setprecision(1) << megabytes / encode_time
+         << setw(12) << megabytes / decode_time
+         << setw(10) << setprecision(0) << audio_seconds / max(encode_time, decode_time) << "x"
+         << setw(8) << (ok ? "OK" : "ERRO") << endl;
+
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    // Frames estéreo por teste (default: 10 minutos a 44.1 kHz)
+    size_t frames = (argc > 1) ? strtoull(argv[1], nullptr, 10) : size_t(44100) * 600;
+    string tmp_file = "range_coder_bench.tmp";
+
+    cout << "Range Coder Benchmark" << endl;
+    cout << "=====================" << endl;
+    cout << fixed;
+    cout << setw(6) << "Bits" << setw(12) << "Bits/amost." << setw(12) << "Cod. MB/s"
+         << setw(12) << "Desc. MB/s" << setw(11) << "T. real" << setw(8) << "Check" << endl;
+
+    bool ok = true;
+    for (int bits : { 4, 8, 12, 16 }) {
+        ok = bench_bits(bits, frames, tmp_file) && ok;
+    }
+
+    remove(tmp_file.c_str());
+    return ok ? 0 : 1;
+}
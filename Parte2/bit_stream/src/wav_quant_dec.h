@@ -3,46 +3,46 @@
 
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <sndfile.hh>
 #include <fstream>
+#include <future>
 #include "bit_stream.h"
+#include "bit_pack.h"
+#include "quantizer.h"
+#include "huffman.h"
+#include "range_coder.h"
 
 class WAVQuantDec {
+public:
+    // Flags no campo targetBits do header (ver WAVQuantEnc)
+    static const int FLAG_HUFFMAN = 0x100;
+    static const int FLAG_RANGE = 0x200;
+    static const int FLAG_LLOYD = 0x400;
+
+    // Frames descodificados e escritos de cada vez (ver WAVQuantEnc)
+    static const int WINDOW_FRAMES = 65536;
+
 private:
-    std::vector<short> samples;
     int sampleRate;
     int channels;
     int frames;
     int targetBits;
-
-    // Dequantização (reconstrução do valor original)
-    short dequantizeSample(int quantizedValue) {
-        if (targetBits >= 16) return static_cast<short>(quantizedValue);
-        
-        int numLevels = 1 << targetBits;
-        double stepSize = 65536.0 / numLevels;
-        
-        // Reconstruir valor no centro do intervalo de quantização
-        double reconstructed = quantizedValue * stepSize - 32768.0 + stepSize / 2.0;
-        
-        // Limitar ao range de 16-bit signed
-        if (reconstructed > 32767.0) reconstructed = 32767.0;
-        if (reconstructed < -32768.0) reconstructed = -32768.0;
-        
-        return static_cast<short>(reconstructed);
-    }
+    bool useHuffman;
+    bool useRange;
+    bool useLloyd;
+    LloydMaxCodebook codebook;
 
 public:
     WAVQuantDec() = default;
 
     void decodeFromFile(const std::string& inputFile, const std::string& outputWav) {
-        std::fstream ifs(inputFile, std::ios::in | std::ios::binary);
-        if (!ifs.is_open()) {
+        // Ficheiro mapeado em memória quando possível (fstream para pipes)
+        BitStream bs(inputFile);
+        if (!bs.is_open()) {
             throw std::runtime_error("Erro ao abrir ficheiro: " + inputFile);
         }
 
-        BitStream bs(ifs, STREAM_READ);
-
         // Ler header
         if (!readHeader(bs)) {
             throw std::runtime_error("Erro ao ler header do ficheiro");
@@ -51,24 +51,44 @@ public:
         std::cout << "=== WAV Quantization Decoder ===" << std::endl;
         std::cout << "Header: " << frames << " frames, " << sampleRate << " Hz, " 
                   << channels << " channels" << std::endl;
-        std::cout << "Quantization: " << targetBits << "-bit → 16-bit" << std::endl;
+        std::cout << "Quantization: " << targetBits << "-bit"
+                  << (useHuffman ? " + Huffman" : useRange ? " + range coder" : "")
+                  << (useLloyd ? " (Lloyd-Max)" : "") << " → 16-bit" << std::endl;
 
-        // Preparar vetor para amostras
-        samples.resize(frames * channels);
+        std::cout << "Descodificando " << static_cast<size_t>(frames) * channels << " amostras..." << std::endl;
 
-        std::cout << "Descodificando " << samples.size() << " amostras..." << std::endl;
+        SndfileHandle sndFileOut{outputWav, SFM_WRITE, SF_FORMAT_WAV | SF_FORMAT_PCM_16,
+                                channels, sampleRate};
+        if (sndFileOut.error()) {
+            throw std::runtime_error("Erro ao criar ficheiro WAV: " + std::string(sndFileOut.strError()));
+        }
 
-        // Ler e dequantizar amostras
-        for (size_t i = 0; i < samples.size(); i++) {
-            uint64_t quantizedValue = bs.read_n_bits(targetBits);
-            samples[i] = dequantizeSample(static_cast<int>(quantizedValue));
+        // Níveis do codebook, logo a seguir ao header
+        if (useLloyd) {
+            codebook = LloydMaxCodebook::read_table(bs, targetBits);
+            if (!codebook.is_valid()) {
+                throw std::runtime_error("Codebook inválido");
+            }
         }
 
-        bs.close();
-        ifs.close();
+        // Ler e dequantizar amostras, escrevendo o WAV janela a janela
+        if (useHuffman) {
+            HuffmanCode code = HuffmanCode::read_table(bs);
+            if (!code.is_valid() || code.num_symbols() != (size_t(1) << targetBits)) {
+                throw std::runtime_error("Tabela de Huffman inválida");
+            }
+            forEachWindow(sndFileOut, [&](uint16_t* quantized, size_t count) {
+                for (size_t i = 0; i < count; i++) {
+                    quantized[i] = static_cast<uint16_t>(code.decode(bs));
+                }
+            });
+        } else if (useRange) {
+            decodeRange(inputFile, sndFileOut);
+        } else {
+            decodeFixed(bs, sndFileOut);
+        }
 
-        // Escrever ficheiro WAV
-        writeWavFile(outputWav);
+        bs.close();
         std::cout << "Descodificação concluída: " << outputWav << std::endl;
     }
 
@@ -78,11 +98,16 @@ private:
             sampleRate = static_cast<int>(bs.read_n_bits(32));
             channels = static_cast<int>(bs.read_n_bits(32));
             frames = static_cast<int>(bs.read_n_bits(32));
-            targetBits = static_cast<int>(bs.read_n_bits(32));
+            int bitsField = static_cast<int>(bs.read_n_bits(32));
+            targetBits = bitsField & 0xFF;
+            useHuffman = (bitsField & FLAG_HUFFMAN) != 0;
+            useRange = (bitsField & FLAG_RANGE) != 0;
+            useLloyd = (bitsField & FLAG_LLOYD) != 0;
             
             // Validar valores
             if (sampleRate <= 0 || channels <= 0 || frames <= 0 || 
-                targetBits < 1 || targetBits > 16) {
+                targetBits < 1 || targetBits > 16 || (useHuffman && useRange) ||
+                (bitsField & ~(0xFF | FLAG_HUFFMAN | FLAG_RANGE | FLAG_LLOYD)) != 0) {
                 return false;
             }
             
@@ -92,18 +117,72 @@ private:
         }
     }
 
-    void writeWavFile(const std::string& outputWav) {
-        SndfileHandle sndFileOut{outputWav, SFM_WRITE, SF_FORMAT_WAV | SF_FORMAT_PCM_16, 
-                                channels, sampleRate};
-        
-        if (sndFileOut.error()) {
-            throw std::runtime_error("Erro ao criar ficheiro WAV: " + std::string(sndFileOut.strError()));
+    // Descodifica o ficheiro em janelas de WINDOW_FRAMES frames: decodeLevels(levels, count)
+    // preenche os níveis de cada uma, que são dequantizados e escritos no WAV. A escrita
+    // de uma janela (std::async) decorre enquanto a seguinte é descodificada, pelo que
+    // há dois buffers de amostras que se alternam
+    template <typename DecodeLevels>
+    void forEachWindow(SndfileHandle& sndFileOut, DecodeLevels decodeLevels) {
+        const size_t windowSamples = static_cast<size_t>(WINDOW_FRAMES) * channels;
+        std::vector<uint16_t> quantized(windowSamples);
+        std::vector<short> buffers[2] = { std::vector<short>(windowSamples), std::vector<short>(windowSamples) };
+        std::future<void> pending;
+        int current = 0;
+
+        for (sf_count_t start = 0; start < frames; start += WINDOW_FRAMES) {
+            sf_count_t windowFrames = std::min<sf_count_t>(WINDOW_FRAMES, frames - start);
+            size_t count = static_cast<size_t>(windowFrames) * channels;
+
+            decodeLevels(quantized.data(), count);
+            if (useLloyd) {
+                codebook.dequantize(quantized.data(), count, buffers[current].data());
+            } else {
+                dequantize_samples(quantized.data(), count, targetBits, buffers[current].data());
+            }
+
+            // A janela anterior (no outro buffer) tem de estar escrita antes desta
+            if (pending.valid()) pending.get();
+            pending = std::async(std::launch::async, [&sndFileOut, &buffer = buffers[current], windowFrames] {
+                if (sndFileOut.writef(buffer.data(), windowFrames) != windowFrames) {
+                    throw std::runtime_error("Erro ao escrever todas as amostras");
+                }
+            });
+            current ^= 1;
         }
+        if (pending.valid()) pending.get();
+    }
+
+    // targetBits bits por amostra, desempacotados em bloco (ver WAVQuantEnc::encodeFixed);
+    // num ficheiro truncado as amostras em falta ficam com o nível 0
+    void decodeFixed(BitStream& bs, SndfileHandle& sndFileOut) {
+        std::vector<uint8_t> packed(bit_packed_bytes(static_cast<size_t>(WINDOW_FRAMES) * channels, targetBits));
+
+        forEachWindow(sndFileOut, [&](uint16_t* quantized, size_t count) {
+            size_t bytes = bit_packed_bytes(count, targetBits);
+            size_t bytesRead = bs.read_bytes(packed.data(), bytes);
+            std::fill(packed.begin() + bytesRead, packed.begin() + bytes, 0);
+            bit_unpack(packed.data(), count, targetBits, quantized);
+        });
+    }
 
-        sf_count_t written = sndFileOut.writef(samples.data(), frames);
-        if (written != frames) {
-            throw std::runtime_error("Erro ao escrever todas as amostras");
+    // O range coder lê bytes a partir do fim do header (16 bytes, mais 2 por nível do
+    // codebook), com um ByteStream próprio porque o BitStream já leu bytes à frente
+    // para o acumulador
+    void decodeRange(const std::string& inputFile, SndfileHandle& sndFileOut) {
+        ByteStream rs(inputFile);
+        std::vector<uint8_t> header(16 + (useLloyd ? size_t(2) << targetBits : 0));
+        if (rs.read(header.data(), header.size()) != header.size()) {
+            throw std::runtime_error("Erro ao ler ficheiro: " + inputFile);
         }
+
+        RangeDecoder rc(rs);
+        SampleModel model(targetBits, channels);
+        forEachWindow(sndFileOut, [&](uint16_t* quantized, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                quantized[i] = static_cast<uint16_t>(model.decode(rc));
+            }
+        });
+        rs.close();
     }
 };
 
@@ -3,9 +3,27 @@
 #include "wav_quant_enc.h"
 
 int main(int argc, char *argv[]) {
-    if (argc != 4) {
-        std::cout << "Usage: " << argv[0] << " <input.wav> <output.bin> <target_bits>" << std::endl;
+    QuantCoding coding = QuantCoding::FIXED;
+    bool lloyd = false;
+    bool validOptions = argc >= 4 && argc <= 6;
+    for (int i = 4; i < argc && validOptions; i++) {
+        std::string option = argv[i];
+        if (option == "lloyd" && !lloyd) {
+            lloyd = true;
+        } else if ((option == "huffman" || option == "range") && coding == QuantCoding::FIXED) {
+            coding = option == "huffman" ? QuantCoding::HUFFMAN : QuantCoding::RANGE;
+        } else {
+            validOptions = false;
+        }
+    }
+
+    if (!validOptions) {
+        std::cout << "Usage: " << argv[0] << " <input.wav> <output.bin> <target_bits> [huffman|range] [lloyd]" << std::endl;
         std::cout << "  target_bits: número de bits para quantização (1-16)" << std::endl;
+        std::cout << "  huffman: codificar os níveis com Huffman canónico em vez de target_bits fixos" << std::endl;
+        std::cout << "  range: codificar os níveis com range coder adaptativo (contexto da amostra anterior)" << std::endl;
+        std::cout << "  lloyd: níveis não uniformes (Lloyd-Max) treinados no histograma do ficheiro (1-15 bits;" << std::endl;
+        std::cout << "         fica uniforme se o ganho de SNR não compensar a tabela)" << std::endl;
         return 1;
     }
 
@@ -22,9 +40,13 @@ int main(int argc, char *argv[]) {
         std::cout << "Erro: target_bits deve estar entre 1 e 16" << std::endl;
         return 1;
     }
+    if (lloyd && target_bits == 16) {
+        std::cout << "Erro: lloyd não tem efeito com 16 bits (a quantização já não tem perdas)" << std::endl;
+        return 1;
+    }
 
     // Criar encoder e processar
-    WAVQuantEnc encoder{sndFileIn, target_bits};
+    WAVQuantEnc encoder{sndFileIn, target_bits, coding, lloyd};
     encoder.quantizeAndEncode(argv[2]);
 
     return 0;
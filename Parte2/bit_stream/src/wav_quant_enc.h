@@ -3,46 +3,52 @@
 
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <sndfile.hh>
 #include <fstream>
 #include <iomanip>
+#include <cmath>
+#include <future>
 #include "bit_stream.h"
+#include "bit_pack.h"
+#include "quantizer.h"
+#include "huffman.h"
+#include "range_coder.h"
+
+// Codificação dos níveis quantizados depois do header
+enum class QuantCoding {
+    FIXED,      // targetBits bits por amostra
+    HUFFMAN,    // Huffman canónico (tabela a seguir ao header)
+    RANGE       // Range coder com o SampleModel (resíduo da amostra anterior)
+};
 
 class WAVQuantEnc {
+public:
+    // Flags no campo targetBits do header
+    static const int FLAG_HUFFMAN = 0x100;
+    static const int FLAG_RANGE = 0x200;
+    static const int FLAG_LLOYD = 0x400;    // Níveis de um LloydMaxCodebook (tabela a seguir ao header)
+
+    // Frames lidos e codificados de cada vez (a memória usada não depende do ficheiro)
+    static const int WINDOW_FRAMES = 65536;
+
 private:
-    std::vector<short> samples;
+    SndfileHandle& sfh;
     int sampleRate;
     int channels;
     int frames;
     int targetBits;
-
-    // Quantização uniforme (baseada no wav_quant original)
-    short quantizeSample(short sample) {
-        if (targetBits >= 16) return sample;
-        
-        int numLevels = 1 << targetBits; // 2^targetBits
-        double stepSize = 65536.0 / numLevels;
-        
-        // Normalizar para [0, numLevels-1]
-        int quantized = static_cast<int>((sample + 32768.0) / stepSize);
-        
-        // Limitar ao range válido
-        if (quantized >= numLevels) quantized = numLevels - 1;
-        if (quantized < 0) quantized = 0;
-        
-        return quantized; // Retornar valor quantizado (0 a numLevels-1)
-    }
+    QuantCoding coding;
+    bool useLloyd;
+    LloydMaxCodebook codebook;
 
 public:
-    WAVQuantEnc(SndfileHandle& sfh, int bits) : targetBits(bits) {
+    // As amostras só são lidas em quantizeAndEncode, janela a janela
+    WAVQuantEnc(SndfileHandle& sfh, int bits, QuantCoding c = QuantCoding::FIXED, bool lloyd = false)
+        : sfh(sfh), targetBits(bits), coding(c), useLloyd(lloyd) {
         frames = sfh.frames();
         sampleRate = sfh.samplerate();
         channels = sfh.channels();
-        samples.resize(frames * channels);
-        
-        if (sfh.readf(samples.data(), frames) != frames) {
-            throw std::runtime_error("Erro ao ler amostras do ficheiro WAV");
-        }
     }
 
     void quantizeAndEncode(const std::string& outputFile) {
@@ -53,7 +59,10 @@ public:
         std::cout << "=== WAV Quantization Encoder ===" << std::endl;
         std::cout << "Input: " << frames << " frames, " << sampleRate << " Hz, " 
                   << channels << " channels" << std::endl;
-        std::cout << "Quantization: 16-bit → " << targetBits << "-bit" << std::endl;
+        std::cout << "Quantization: 16-bit → " << targetBits << "-bit"
+                  << (coding == QuantCoding::HUFFMAN ? " + Huffman" :
+                      coding == QuantCoding::RANGE ? " + range coder" : "")
+                  << (useLloyd ? " (Lloyd-Max)" : "") << std::endl;
 
         std::fstream ofs(outputFile, std::ios::out | std::ios::binary);
         if (!ofs.is_open()) {
@@ -62,23 +71,44 @@ public:
 
         BitStream bs(ofs, STREAM_WRITE);
 
+        // O codebook e a tabela de Huffman precisam do histograma do ficheiro todo
+        std::vector<uint64_t> histogram;
+        if (useLloyd || coding == QuantCoding::HUFFMAN) {
+            histogram = sampleHistogram();
+        }
+
+        // Treinar antes do header: sem ganho, o FLAG_LLOYD não é escrito
+        if (useLloyd) {
+            trainCodebook(histogram);
+        }
+
         // Escrever header
         writeHeader(bs);
 
+        size_t headerBits = 128;
+        if (useLloyd) {
+            codebook.write_table(bs);
+            headerBits += size_t(16) << targetBits;
+        }
+
         // Quantizar e codificar
-        std::cout << "Codificando " << samples.size() << " amostras..." << std::endl;
+        size_t numSamples = static_cast<size_t>(frames) * channels;
+        std::cout << "Codificando " << numSamples << " amostras..." << std::endl;
 
-        for (size_t i = 0; i < samples.size(); i++) {
-            int quantizedValue = quantizeSample(samples[i]);
-            bs.write_n_bits(quantizedValue, targetBits);
+        size_t encodedBits = headerBits + numSamples * targetBits; // header + dados
+        if (coding == QuantCoding::HUFFMAN) {
+            encodedBits = headerBits + encodeHuffman(bs, histogram);
+        } else if (coding == QuantCoding::RANGE) {
+            encodedBits = headerBits + encodeRange(bs, ofs);
+        } else {
+            encodeFixed(bs);
         }
 
         bs.close();
         ofs.close();
 
         // Estatísticas
-        size_t originalBits = samples.size() * 16;
-        size_t encodedBits = 128 + samples.size() * targetBits; // header + dados
+        size_t originalBits = numSamples * 16;
         double compressionRatio = static_cast<double>(originalBits) / encodedBits;
 
         std::cout << "Codificação concluída!" << std::endl;
@@ -94,7 +124,187 @@ private:
         bs.write_n_bits(sampleRate, 32);
         bs.write_n_bits(channels, 32);
         bs.write_n_bits(frames, 32);
-        bs.write_n_bits(targetBits, 32);
+        bs.write_n_bits(targetBits | (coding == QuantCoding::HUFFMAN ? FLAG_HUFFMAN : 0) |
+                        (coding == QuantCoding::RANGE ? FLAG_RANGE : 0) |
+                        (useLloyd ? FLAG_LLOYD : 0), 32);
+    }
+
+    // Treina o codebook no histograma; fica a quantização uniforme se o ganho de SNR
+    // não chegar a LLOYD_MIN_GAIN_DB (com 16 bits a uniforme já não tem perdas e a
+    // tabela teria 128 KB)
+    void trainCodebook(const std::vector<uint64_t>& histogram) {
+        if (targetBits >= QUANT_MAX_BITS) {
+            std::cout << "Lloyd-Max: sem efeito com " << targetBits << " bits, quantização uniforme" << std::endl;
+            useLloyd = false;
+            return;
+        }
+
+        double uniformSNR = histogramSNR(histogram);
+        codebook = LloydMaxCodebook::from_histogram(histogram, targetBits);
+        double lloydSNR = histogramSNR(histogram);
+
+        std::cout << "Lloyd-Max: SNR " << std::fixed << std::setprecision(2) << lloydSNR
+                  << " dB (uniforme: " << uniformSNR << " dB)";
+        if (!(lloydSNR >= uniformSNR + LLOYD_MIN_GAIN_DB)) {
+            codebook = LloydMaxCodebook();
+            useLloyd = false;
+            std::cout << ", ganho insuficiente para a tabela, quantização uniforme";
+        }
+        std::cout << std::endl;
+    }
+
+    // Níveis das amostras: codebook, depois de treinado, ou quantização uniforme
+    void quantize(const short* samples, size_t count, uint16_t* levels) {
+        if (codebook.is_valid()) {
+            codebook.quantize(samples, count, levels);
+        } else {
+            quantize_samples(samples, count, targetBits, levels);
+        }
+    }
+
+    void reconstruct(const uint16_t* levels, size_t count, short* samples) {
+        if (codebook.is_valid()) {
+            codebook.dequantize(levels, count, samples);
+        } else {
+            dequantize_samples(levels, count, targetBits, samples);
+        }
+    }
+
+    // Quantiza cada uma das 65536 amostras possíveis (índice amostra + 32768)
+    std::vector<uint16_t> quantizeAllSamples() {
+        std::vector<short> all(65536);
+        for (int i = 0; i < 65536; i++) {
+            all[i] = static_cast<short>(i - 32768);
+        }
+        std::vector<uint16_t> levels(all.size());
+        quantize(all.data(), all.size(), levels.data());
+        return levels;
+    }
+
+    // Histograma das amostras (índice amostra + 32768) do ficheiro todo, como o
+    // WAVHist mas com os canais juntos; o ficheiro volta ao início
+    std::vector<uint64_t> sampleHistogram() {
+        std::vector<uint64_t> histogram(65536, 0);
+        readWindows([&](const short* window, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                histogram[static_cast<uint16_t>(window[i]) ^ 0x8000]++;
+            }
+        });
+
+        if (sfh.seek(0, SEEK_SET) != 0) {
+            throw std::runtime_error("Erro ao voltar ao início do ficheiro WAV");
+        }
+        return histogram;
+    }
+
+    // SNR do quantizador atual sobre o histograma das amostras
+    double histogramSNR(const std::vector<uint64_t>& histogram) {
+        std::vector<uint16_t> levels = quantizeAllSamples();
+        std::vector<short> reconstructed(levels.size());
+        reconstruct(levels.data(), levels.size(), reconstructed.data());
+
+        double signal = 0.0, noise = 0.0;
+        for (int i = 0; i < 65536; i++) {
+            double x = i - 32768.0;
+            double error = x - reconstructed[i];
+            signal += histogram[i] * x * x;
+            noise += histogram[i] * error * error;
+        }
+        return noise > 0.0 ? 10.0 * std::log10(signal / noise) : INFINITY;
+    }
+
+    // Lê o ficheiro em janelas de WINDOW_FRAMES frames e passa as amostras de cada uma
+    // a process(samples, count); a leitura da janela seguinte (std::async) decorre
+    // enquanto a atual é processada
+    template <typename Process>
+    void readWindows(Process process) {
+        const size_t windowSamples = static_cast<size_t>(WINDOW_FRAMES) * channels;
+        std::vector<short> current(windowSamples), next(windowSamples);
+
+        auto readWindow = [this](std::vector<short>& buffer, sf_count_t start) -> size_t {
+            sf_count_t count = std::min<sf_count_t>(WINDOW_FRAMES, frames - start);
+            if (count <= 0) return 0;
+            if (sfh.readf(buffer.data(), count) != count) {
+                throw std::runtime_error("Erro ao ler amostras do ficheiro WAV");
+            }
+            return static_cast<size_t>(count) * channels;
+        };
+
+        size_t count = readWindow(current, 0);
+        for (sf_count_t start = 0; start < frames; start += WINDOW_FRAMES) {
+            auto pending = std::async(std::launch::async, readWindow, std::ref(next), start + WINDOW_FRAMES);
+
+            process(current.data(), count);
+
+            count = pending.get();
+            std::swap(current, next);
+        }
+    }
+
+    // Como readWindows, mas passa os níveis quantizados: process(levels, count)
+    template <typename Process>
+    void forEachWindow(Process process) {
+        std::vector<uint16_t> quantized(static_cast<size_t>(WINDOW_FRAMES) * channels);
+        readWindows([&](const short* samples, size_t count) {
+            quantize(samples, count, quantized.data());
+            process(quantized.data(), count);
+        });
+    }
+
+    // targetBits bits por amostra, empacotados em bloco (o header tem 128 bits, pelo
+    // que os dados começam alinhados ao byte); as janelas têm um número de amostras
+    // múltiplo de 8, pelo que só a última pode acabar a meio de um byte
+    void encodeFixed(BitStream& bs) {
+        std::vector<uint8_t> packed(bit_packed_bytes(static_cast<size_t>(WINDOW_FRAMES) * channels, targetBits));
+
+        forEachWindow([&](const uint16_t* quantized, size_t count) {
+            bit_pack(quantized, count, targetBits, packed.data());
+            bs.write_bytes(packed.data(), bit_packed_bytes(count, targetBits));
+        });
+    }
+
+    // Código de Huffman dos níveis quantizados (tabela logo a seguir ao header ou ao
+    // codebook), seguido dos códigos das amostras; devolve o número de bits escritos.
+    // O histograma dos níveis sai do das amostras, lido antes numa primeira passagem
+    size_t encodeHuffman(BitStream& bs, const std::vector<uint64_t>& sampleHistogram) {
+        std::vector<uint16_t> levels = quantizeAllSamples();
+        std::vector<uint64_t> histogram(size_t(1) << targetBits, 0);
+        for (int i = 0; i < 65536; i++) {
+            histogram[levels[i]] += sampleHistogram[i];
+        }
+
+        HuffmanCode code = HuffmanCode::from_histogram(histogram);
+        size_t tableStart = bs.get_total_bits();
+        code.write_table(bs);
+        size_t tableBits = bs.get_total_bits() - tableStart;
+
+        forEachWindow([&](const uint16_t* quantized, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                code.encode(bs, quantized[i]);
+            }
+        });
+        return tableBits + code.encoded_bits(histogram);
+    }
+
+    // Range coder a escrever diretamente no ficheiro, a seguir ao header (que tem
+    // 128 bits, mais 16 por nível do codebook, pelo que o BitStream fica alinhado ao
+    // byte); devolve os bits escritos
+    size_t encodeRange(BitStream& bs, std::fstream& ofs) {
+        bs.flush();
+
+        ByteStream rs(ofs, STREAM_WRITE);
+        RangeEncoder rc(rs);
+        SampleModel model(targetBits, channels);
+        forEachWindow([&](const uint16_t* quantized, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                // Com 16 bits (uniforme) o nível é a amostra, que o modelo recebe com sinal
+                model.encode(rc, targetBits == 16 && !useLloyd ? static_cast<short>(quantized[i]) : quantized[i]);
+            }
+        });
+        rc.flush();
+        rs.flush();
+
+        return rc.bytes_written() * 8;
     }
 };
 
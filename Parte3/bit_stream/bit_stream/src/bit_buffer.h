@@ -0,0 +1,84 @@
+//-------------------------------------------------------------------------------------------
+//
+// BitBuffer - Sequência de bits em memória, com a mesma ordem que o BitStream
+// (MSB primeiro), para codificar blocos em paralelo e concatená-los depois
+// BitCounter - Só conta os bits, para estimar o débito sem os escrever
+//
+//-------------------------------------------------------------------------------------------
+
+#ifndef BIT_BUFFER_H
+#define BIT_BUFFER_H
+
+#include <vector>
+#include <cstdint>
+#include "bit_stream.h"
+
+class BitBuffer {
+  private:
+	std::vector<uint64_t>	m_words;		// Complete 64-bit words
+	uint64_t				m_acc { };		// Bits of the incomplete word (right-aligned)
+	int						m_acc_bits { };
+
+  public:
+	void write_bit(int bit) {
+		m_acc = (m_acc << 1) | (bit & 0x01);
+		if(++m_acc_bits == 64) {
+			m_words.push_back(m_acc);
+			m_acc = 0;
+			m_acc_bits = 0;
+		}
+	}
+
+	void write_n_bits(uint64_t bits, int n) {
+		if(n <= 0)
+			return;
+
+		if(n < 64)
+			bits &= (uint64_t(1) << n) - 1;
+
+		int room = 64 - m_acc_bits;
+		if(n < room) {
+			m_acc = (m_acc << n) | bits;
+			m_acc_bits += n;
+			return;
+		}
+
+		int rest = n - room;
+		m_words.push_back(room == 64 ? bits : (m_acc << room) | (bits >> rest));
+		m_acc = bits & ((uint64_t(1) << rest) - 1);
+		m_acc_bits = rest;
+	}
+
+	// Number of bits written so far
+	uint64_t size() const {
+		return 64 * static_cast<uint64_t>(m_words.size()) + m_acc_bits;
+	}
+
+	void clear() {
+		m_words.clear();
+		m_acc = 0;
+		m_acc_bits = 0;
+	}
+
+	// Writes the whole buffer to a bit stream, one word at a time
+	void append_to(BitStream& bs) const {
+		for(uint64_t word : m_words)
+			bs.write_n_bits(word, 64);
+
+		bs.write_n_bits(m_acc, m_acc_bits);
+	}
+};
+
+// Counts the bits that would be written, without storing them (rate estimates)
+class BitCounter {
+  private:
+	uint64_t	m_bits { };
+
+  public:
+	void write_bit(int) { m_bits++; }
+	void write_n_bits(uint64_t, int n) { m_bits += (n > 0) ? n : 0; }
+	uint64_t size() const { return m_bits; }
+	void clear() { m_bits = 0; }
+};
+
+#endif
@@ -19,39 +19,110 @@
 #include <cstdint>
 #include <fstream>
 #include <string>
+#include <algorithm>
 #include "bit_stream.h"
 
 using namespace std;
 
 BitStream::BitStream(fstream& fs, bool rw_status) : m_rw_status { rw_status },
   m_byte_stream { fs, rw_status } {
-	if(rw_status) {
-		m_bit_ptr = -1;
-	} else {
-		m_bit_ptr = 7;
-		m_buf = 0;
+}
+
+BitStream::BitStream(const string& filename) : m_rw_status { STREAM_READ },
+  m_byte_stream { filename } {
+}
+
+//---------------------------------------------------------------------------------
+//
+// Writes a full accumulator to the byte stream (big-endian, i.e., MSB first)
+//
+void BitStream::put_word(uint64_t word) {
+	uint8_t bytes[8];
+	for(int i = 7 ; i >= 0 ; --i) {
+		bytes[i] = word & 0xFF;
+		word >>= 8;
 	}
+
+	m_byte_stream.write(bytes, 8);
+}
+
+//---------------------------------------------------------------------------------
+//
+// Writes the bits left in the accumulator, padding the last byte with zeros
+//
+void BitStream::put_pending_bits() {
+	if(m_acc_bits == 0)
+		return;
+
+	int n_bytes = (m_acc_bits + 7) / 8;
+	uint64_t word = m_acc << (8 * n_bytes - m_acc_bits);
+	for(int i = n_bytes - 1 ; i >= 0 ; --i)
+		m_byte_stream.put((word >> (8 * i)) & 0xFF);
+
+	m_acc = 0;
+	m_acc_bits = 0;
+}
+
+//---------------------------------------------------------------------------------
+//
+// Tops up the accumulator with as many whole bytes as fit in it
+//
+void BitStream::fill_acc() {
+	uint8_t bytes[8];
+	size_t n_bytes = m_byte_stream.read(bytes, (64 - m_acc_bits) / 8);
+	for(size_t i = 0 ; i < n_bytes ; ++i)
+		m_acc = (m_acc << 8) | bytes[i];
+
+	m_acc_bits += 8 * n_bytes;
 }
 
 int BitStream::read_bit() {
-	if(--m_bit_ptr < 0) {
-		if((m_buf = m_byte_stream.get()) == EOF)
+	if(m_acc_bits == 0) {
+		fill_acc();
+		if(m_acc_bits == 0)
 			return EOF;
-
-		m_bit_ptr = 7;
 	}
 
-	return (m_buf & (0x01 << m_bit_ptr)) >> m_bit_ptr;
+	return (m_acc >> --m_acc_bits) & 0x01;
 }
 
 uint64_t BitStream::read_n_bits(int n) {
-	uint64_t x { };
-	for(int i = 0 ; i < n ; ++i) {
-		x <<= 1;
-		x |= read_bit();
+	if(n <= 0)
+		return 0;
+
+	if(n > 32) { // Keeps every request within a single refill
+		uint64_t x = read_n_bits(n - 32);
+		return (x << 32) | read_n_bits(32);
+	}
+
+	if(m_acc_bits < n) {
+		fill_acc();
+		if(m_acc_bits < n) { // End of file: return whatever is left
+			n = m_acc_bits;
+			if(n == 0)
+				return 0;
+		}
+	}
+
+	m_acc_bits -= n;
+	return (m_acc >> m_acc_bits) & ((uint64_t(1) << n) - 1);
+}
+
+uint64_t BitStream::peek_n_bits(int n) {
+	if(n <= 0)
+		return 0;
+
+	if(m_acc_bits < n) {
+		fill_acc();
+		if(m_acc_bits < n) // End of file: pad with zeros
+			return (m_acc << (n - m_acc_bits)) & ((uint64_t(1) << n) - 1);
 	}
 
-	return x;
+	return (m_acc >> (m_acc_bits - n)) & ((uint64_t(1) << n) - 1);
+}
+
+void BitStream::skip_n_bits(int n) {
+	m_acc_bits -= min(n, m_acc_bits);
 }
 
 string BitStream::read_string() {
@@ -65,18 +136,35 @@ string BitStream::read_string() {
 }
 
 void BitStream::write_bit(int bit) {
-	if(m_bit_ptr < 0) {
-		m_byte_stream.put(m_buf);
-		m_bit_ptr = 7;
-		m_buf = 0;
+	m_acc = (m_acc << 1) | (bit & 0x01);
+	if(++m_acc_bits == 64) {
+		put_word(m_acc);
+		m_acc = 0;
+		m_acc_bits = 0;
 	}
-
-	m_buf |= (bit & 0x01) << m_bit_ptr--;
 }
 
 void BitStream::write_n_bits(uint64_t bits, int n) {
-	for(int i = n - 1 ; i >= 0 ; i--)
-		write_bit(((0x01 << i) & bits) >> i);
+	if(n <= 0)
+		return;
+
+	if(n < 64)
+		bits &= (uint64_t(1) << n) - 1;
+
+	int room = 64 - m_acc_bits;
+	if(n < room) {
+		m_acc = (m_acc << n) | bits;
+		m_acc_bits += n;
+		return;
+	}
+
+	// The accumulator becomes full: complete it with the most significant
+	// bits of the field and keep the remaining ones
+	int rest = n - room;
+	m_acc = room == 64 ? bits : (m_acc << room) | (bits >> rest);
+	put_word(m_acc);
+	m_acc = bits & ((uint64_t(1) << rest) - 1);
+	m_acc_bits = rest;
 }
 
 void BitStream::write_string(const string& s) {
@@ -86,15 +174,24 @@ void BitStream::write_string(const string& s) {
 	write_n_bits('\n', 8); // Mark the end of the string with a newline
 }
 
+void BitStream::seek(uint64_t bit) {
+	m_byte_stream.seek(bit / 8);
+	m_acc = 0;
+	m_acc_bits = 0;
+	read_n_bits(bit % 8);
+}
+
 off_t BitStream::tell() {
-	return m_byte_stream.tell();
+	// Whole bytes still held in the accumulator belong to the logical position
+	if(m_rw_status == STREAM_WRITE)
+		return m_byte_stream.tell() + m_acc_bits / 8;
+
+	return m_byte_stream.tell() - m_acc_bits / 8;
 }
 
 void BitStream::close() {
-	if(not m_rw_status) {
-		if(m_bit_ptr != 7) // Flush the bit buffer only if there are some bits there
-			m_byte_stream.put(m_buf);
-	}
+	if(not m_rw_status)
+		put_pending_bits(); // Flush the bit buffer only if there are some bits there
 
 	m_byte_stream.close(); // Calls byte_stream flush if needed
 }
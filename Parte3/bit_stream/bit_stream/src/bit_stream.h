@@ -23,15 +23,24 @@
 #include <fstream>
 #include "byte_stream.h"
 
+// Bits are moved through a 64-bit accumulator: writes are emitted to the byte
+// stream one 64-bit word at a time and reads refill up to 8 bytes at once, so a
+// field of n bits costs O(1) instead of n calls to read_bit/write_bit. The file
+// format is unchanged (MSB first, last byte padded with zeros).
 class BitStream {
   private:
 	bool		m_rw_status { STREAM_READ };
-	int			m_buf;
-	int			m_bit_ptr;
+	uint64_t	m_acc { };		// Bit accumulator (right-aligned)
+	int			m_acc_bits { };	// Number of valid bits in the accumulator
 	ByteStream	m_byte_stream;
 
+	void put_word(uint64_t word);
+	void put_pending_bits();
+	void fill_acc();
+
   public:
 	BitStream(std::fstream& fs, bool rw_status);
+	BitStream(const std::string& filename); // Read-only, memory-mapped when possible
 
 	BitStream() = delete;
 	BitStream(const BitStream&) = delete;
@@ -41,12 +50,17 @@ class BitStream {
 
 	int read_bit();
 	uint64_t read_n_bits(int n);
+	uint64_t peek_n_bits(int n);	// Next n <= 32 bits without consuming them (zeros past EOF)
+	void skip_n_bits(int n);		// Consumes bits already seen with peek_n_bits
 	std::string read_string();
 	void write_bit(int bit);
 	void write_n_bits(uint64_t bits, int n);
 	void write_string(const std::string& s);
+	void seek(uint64_t bit);		// Read mode only: next bit read is bit number 'bit' of the file
 	off_t tell();
 	void close();
+	bool is_open() const { return m_byte_stream.is_open(); }
+	bool is_mapped() const { return m_byte_stream.is_mapped(); }
 };
 
 #endif
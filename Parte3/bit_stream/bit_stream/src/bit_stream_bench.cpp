@@ -0,0 +1,98 @@
+//-------------------------------------------------------------------------------------------
+//
+// BitStream Benchmark - Débito de escrita/leitura de campos de n bits
+//
+//-------------------------------------------------------------------------------------------
+
+#include "bit_stream.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+
+using namespace std;
+
+/**
+ * @brief Escreve e lê de volta campos com uma dada largura, medindo o débito
+ * @param width Largura de cada campo em bits
+ * @param total_bits Número aproximado de bits a processar
+ * @param tmp_file Ficheiro temporário usado pelo teste
+ * @return true se os valores lidos coincidirem com os escritos
+ */
+bool bench_width(int width, uint64_t total_bits, const string& tmp_file) {
+    size_t num_fields = total_bits / width;
+    uint64_t mask = (width == 64) ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+
+    // Valores pseudo-aleatórios (xorshift) gerados antes para não contar no tempo
+    vector<uint64_t> values(num_fields);
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (auto& v : values) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        v = x & mask;
+    }
+
+    // Escrita
+    auto start_write = chrono::high_resolution_clock::now();
+    {
+        fstream ofs(tmp_file, ios::out | ios::binary);
+        BitStream obs(ofs, STREAM_WRITE);
+        for (uint64_t v : values) {
+            obs.write_n_bits(v, width);
+        }
+        obs.close();
+    }
+    auto end_write = chrono::high_resolution_clock::now();
+
+    // Leitura
+    bool ok = true;
+    auto start_read = chrono::high_resolution_clock::now();
+    {
+        fstream ifs(tmp_file, ios::in | ios::binary);
+        BitStream ibs(ifs, STREAM_READ);
+        for (uint64_t v : values) {
+            if (ibs.read_n_bits(width) != v) {
+                ok = false;
+            }
+        }
+        ibs.close();
+    }
+    auto end_read = chrono::high_resolution_clock::now();
+
+    double write_time = chrono::duration<double>(end_write - start_write).count();
+    double read_time = chrono::duration<double>(end_read - start_read).count();
+    double bits = static_cast<double>(num_fields) * width;
+
+    cout << setw(6) << width
+         << setw(14) << num_fields
+         << setw(16) << bits / write_time / 1e6
+         << setw(16) << bits / read_time / 1e6
+         << setw(8) << (ok ? "OK" : "ERRO") << endl;
+
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    // Número de bits por largura (default: 256 Mbit)
+    uint64_t total_bits = (argc > 1) ? strtoull(argv[1], nullptr, 10) : (uint64_t(1) << 28);
+    string tmp_file = "bit_stream_bench.tmp";
+
+    cout << "BitStream Benchmark" << endl;
+    cout << "===================" << endl;
+    cout << fixed << setprecision(1);
+    cout << setw(6) << "Bits" << setw(14) << "Campos"
+         << setw(16) << "Escrita Mb/s" << setw(16) << "Leitura Mb/s"
+         << setw(8) << "Check" << endl;
+
+    bool ok = true;
+    for (int width : {1, 8, 15, 32}) {
+        ok = bench_width(width, total_bits, tmp_file) && ok;
+    }
+
+    remove(tmp_file.c_str());
+    return ok ? 0 : 1;
+}
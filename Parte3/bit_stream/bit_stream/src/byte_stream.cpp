@@ -16,8 +16,17 @@
 //
 //-------------------------------------------------------------------------------------------
 
+#include <cstring>
+#include <algorithm>
 #include "byte_stream.h"
 
+#ifdef BYTE_STREAM_HAS_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 
 //-------------------------------------------------------------------------------------------
@@ -33,6 +42,69 @@ ByteStream::ByteStream(fstream& fs, bool rw_status) : m_rw_status { rw_status },
 		m_buf_ptr = m_buf;
 }
 
+//---------------------------------------------------------------------------------
+//
+// Read-only stream: the file is decoded straight from a memory mapping; the
+// fstream path is the fallback for pipes and other non-seekable inputs
+//
+ByteStream::ByteStream(const string& filename) : m_rw_status { STREAM_READ }, m_fs { m_own_fs } {
+	m_buf_limit = m_buf + BYTE_STREAM_BUF_SIZE;
+	m_buf_ptr = m_buf_limit;
+	m_size = BYTE_STREAM_BUF_SIZE;
+
+	if(not map_file(filename)) // Not a regular file (or no mmap): use the fstream
+		m_own_fs.open(filename, ios::in | ios::binary);
+}
+
+//---------------------------------------------------------------------------------
+
+ByteStream::~ByteStream() {
+	unmap_file();
+}
+
+//---------------------------------------------------------------------------------
+//
+// Maps a regular, non-empty file for sequential reading
+//
+bool ByteStream::map_file(const string& filename) {
+#ifdef BYTE_STREAM_HAS_MMAP
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if(fd < 0)
+		return false;
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 or not S_ISREG(st.st_mode) or st.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+
+	void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd); // The mapping keeps its own reference to the file
+	if(map == MAP_FAILED)
+		return false;
+
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+	m_map = static_cast<const uint8_t*>(map);
+	m_map_ptr = m_map;
+	m_map_limit = m_map + st.st_size;
+	return true;
+#else
+	(void)filename;
+	return false;
+#endif
+}
+
+//---------------------------------------------------------------------------------
+
+void ByteStream::unmap_file() {
+#ifdef BYTE_STREAM_HAS_MMAP
+	if(m_map != nullptr) {
+		munmap(const_cast<uint8_t*>(m_map), m_map_limit - m_map);
+		m_map = m_map_ptr = m_map_limit = nullptr;
+	}
+#endif
+}
+
 //---------------------------------------------------------------------------------
 //
 // m_buf_ptr points to the next free buffer position
@@ -52,6 +124,14 @@ void ByteStream::put(int c) {
 // m_buf_ptr points to the next buffer char
 //
 int ByteStream::get() {
+	if(m_map != nullptr) { // Memory-mapped: no buffer refills
+		if(m_map_ptr == m_map_limit)
+			return EOF;
+
+		m_tell++;
+		return *m_map_ptr++;
+	}
+
 	if(m_buf_ptr == m_buf_limit) { // buffer is empty: get another block
 		m_fs.read((char*)m_buf, BYTE_STREAM_BUF_SIZE);
 		if((m_size = m_fs.gcount()) == 0)
@@ -67,6 +147,66 @@ int ByteStream::get() {
 	return *m_buf_ptr++;
 }
 
+//---------------------------------------------------------------------------------
+//
+// Block version of put(): copies n bytes into the buffer, writing it whenever it
+// becomes full
+//
+void ByteStream::write(const uint8_t* data, size_t n) {
+	m_tell += n;
+
+	while(n > 0) {
+		size_t n_bytes = min(n, static_cast<size_t>(m_buf_limit - m_buf_ptr));
+		memcpy(m_buf_ptr, data, n_bytes);
+		m_buf_ptr += n_bytes;
+		data += n_bytes;
+		n -= n_bytes;
+
+		if(m_buf_ptr == m_buf_limit) { // buffer is full: write it
+			m_fs.write((char*)m_buf, BYTE_STREAM_BUF_SIZE);
+			m_buf_ptr = m_buf;
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------
+//
+// Block version of get(): copies up to n bytes out of the buffer and returns how
+// many were available (less than n only at the end of the file)
+//
+size_t ByteStream::read(uint8_t* data, size_t n) {
+	if(m_map != nullptr) {
+		n = min(n, static_cast<size_t>(m_map_limit - m_map_ptr));
+		memcpy(data, m_map_ptr, n);
+		m_map_ptr += n;
+		m_tell += n;
+		return n;
+	}
+
+	size_t n_read { };
+
+	while(n_read < n) {
+		if(m_buf_ptr == m_buf_limit) { // buffer is empty: get another block
+			m_fs.read((char*)m_buf, BYTE_STREAM_BUF_SIZE);
+			if((m_size = m_fs.gcount()) == 0)
+				break;
+
+			m_buf_ptr = m_buf;
+		}
+
+		size_t n_bytes = min(n - n_read, static_cast<size_t>(m_buf + m_size - m_buf_ptr));
+		if(n_bytes == 0)
+			break;
+
+		memcpy(data + n_read, m_buf_ptr, n_bytes);
+		m_buf_ptr += n_bytes;
+		n_read += n_bytes;
+	}
+
+	m_tell += n_read;
+	return n_read;
+}
+
 //---------------------------------------------------------------------------------
 //
 // m_buf_ptr points to a free buffer position
@@ -80,6 +220,24 @@ void ByteStream::flush() {
 	}
 }
 
+//---------------------------------------------------------------------------------
+//
+// Read mode only: moves to byte pos of the file, discarding the buffered bytes
+//
+void ByteStream::seek(off_t pos) {
+	if(m_map != nullptr)
+		m_map_ptr = m_map + min(pos, static_cast<off_t>(m_map_limit - m_map));
+
+	else {
+		m_fs.clear();
+		m_fs.seekg(pos);
+		m_buf_ptr = m_buf_limit;
+		m_size = BYTE_STREAM_BUF_SIZE;
+	}
+
+	m_tell = pos;
+}
+
 //---------------------------------------------------------------------------------
 
 off_t ByteStream::tell() {
@@ -92,8 +250,15 @@ void ByteStream::close() {
 	if(not m_rw_status)
 		this->flush();
 
+	unmap_file();
 	m_fs.close();
 }
 
 //---------------------------------------------------------------------------------
 
+bool ByteStream::is_open() const {
+	return m_map != nullptr or m_fs.is_open();
+}
+
+//---------------------------------------------------------------------------------
+
@@ -20,7 +20,13 @@
 #define BYTE_STREAM_H
 
 #include <fstream>
+#include <string>
 #include <cstdint>
+#include <cstddef>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BYTE_STREAM_HAS_MMAP
+#endif
 
 const int BYTE_STREAM_BUF_SIZE = 65536;
 const bool STREAM_READ = true;
@@ -34,10 +40,21 @@ class ByteStream {
 	int				m_size;
 	bool			m_rw_status { STREAM_READ };
 	off_t			m_tell { };
+	std::fstream	m_own_fs;
 	std::fstream&	m_fs;
+	const uint8_t*	m_map { };		// Memory-mapped file (read mode only)
+	const uint8_t*	m_map_ptr { };
+	const uint8_t*	m_map_limit { };
+
+	bool map_file(const std::string& filename);
+	void unmap_file();
 
   public:
 	ByteStream(std::fstream& fs, bool rw_status);
+	// Read-only stream over a file: the file is memory-mapped when possible
+	// (regular files) and read through an fstream otherwise (pipes, ...)
+	ByteStream(const std::string& filename);
+	~ByteStream();
 
 	ByteStream() = delete;
 	ByteStream(const ByteStream&) = delete;
@@ -47,9 +64,14 @@ class ByteStream {
 
 	void put(int c);
 	int get();
+	void write(const uint8_t* data, size_t n);
+	size_t read(uint8_t* data, size_t n);
 	void flush();
+	void seek(off_t pos);	// Read mode only: next byte read is byte pos of the file
 	off_t tell();
 	void close();
+	bool is_open() const;
+	bool is_mapped() const { return m_map != nullptr; }
 };
 
 #endif
@@ -0,0 +1,286 @@
+//-------------------------------------------------------------------------------------------
+//
+// DCT Batch - Codifica/descodifica muitos ficheiros em paralelo
+//
+// Os ficheiros são tarefas de um ThreadPool com roubo de tarefas, começando pelos
+// maiores. Os segmentos de cada ficheiro são por sua vez tarefas do mesmo pool, pelo
+// que as threads que ficam sem ficheiros ajudam nos que ainda estão a meio e um
+// ficheiro longo não fica sozinho no fim.
+//
+//-------------------------------------------------------------------------------------------
+
+#include "dct_codec.h"
+#include "thread_pool.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <chrono>
+#include <mutex>
+#include <map>
+#include <iomanip>
+#include <cstdlib>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+/**
+ * @brief Ficheiro a processar
+ */
+struct BatchJob {
+    fs::path input;
+    fs::path output;
+    uintmax_t size;         // Bytes do ficheiro de entrada
+    bool ok = false;
+    double seconds = 0.0;   // Tempo de processamento
+    double audio = 0.0;     // Duração do áudio em segundos
+};
+
+/**
+ * @brief Junta os ficheiros de uma entrada: diretório (recursivo), lista de
+ *        ficheiros (.txt/.lst, um caminho por linha) ou ficheiro
+ * @param extension Extensão dos ficheiros a processar nos diretórios
+ */
+void collect_jobs(const fs::path& input, const string& extension, const fs::path& output_dir,
+                  const string& output_extension, vector<BatchJob>& jobs) {
+    auto add = [&](const fs::path& file, const fs::path& relative) {
+        fs::path output = output_dir / relative;
+        output.replace_extension(output_extension);
+        jobs.push_back({ file, output, fs::file_size(file) });
+    };
+
+    if (fs::is_directory(input)) {
+        for (const auto& entry : fs::recursive_directory_iterator(input)) {
+            if (entry.is_regular_file() && entry.path().extension() == extension) {
+                add(entry.path(), fs::relative(entry.path(), input));
+            }
+        }
+    } else if (input.extension() == ".txt" || input.extension() == ".lst") {
+        ifstream list(input);
+        string line;
+        while (getline(list, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            if (!fs::is_regular_file(line)) {
+                cerr << "Aviso: " << line << " não existe, ignorado" << endl;
+                continue;
+            }
+            add(line, fs::path(line).filename());
+        }
+    } else if (fs::is_regular_file(input)) {
+        add(input, input.filename());
+    } else {
+        cerr << "Aviso: " << input << " não existe, ignorado" << endl;
+    }
+}
+
+/**
+ * @brief Verifica que não há dois ficheiros de entrada com o mesmo ficheiro de saída
+ *
+ * Entradas de listas e ficheiros soltos vão para a raiz do diretório de saída, pelo
+ * que dois ficheiros com o mesmo nome (a/x.wav e b/x.wav) seriam escritos em
+ * simultâneo no mesmo destino.
+ */
+bool unique_outputs(const vector<BatchJob>& jobs) {
+    map<fs::path, const BatchJob*> outputs;
+    bool ok = true;
+    for (const auto& job : jobs) {
+        auto [it, inserted] = outputs.emplace(job.output.lexically_normal(), &job);
+        if (!inserted) {
+            cerr << "Erro: " << it->second->input.string() << " e " << job.input.string()
+                 << " têm a mesma saída " << job.output.string() << endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Duração em segundos de um ficheiro WAV (0 se não for legível)
+ */
+double wav_duration(const fs::path& file) {
+    WAVReader reader;
+    if (!reader.open(file.string())) return 0.0;
+    const WAVHeader& header = reader.header();
+    return static_cast<double>(reader.num_samples()) / (static_cast<double>(header.sample_rate) * header.num_channels);
+}
+
+int main(int argc, char* argv[]) {
+    cout << "DCT Batch Encoder/Decoder" << endl;
+    cout << "=========================" << endl;
+
+    // Separar opções dos argumentos posicionais
+    vector<string> inputs;
+    string output_dir;
+    int num_threads = 0;
+    bool decode = false;
+    int block_size = 512;
+    int num_coeffs = 256;
+    int quant_factor = 2;
+    DCTCoding coding = DCTCoding::RAW;
+    bool eob = false;
+    bool mid_side = false;
+    bool seek_index = false;
+    double target_kbps = 0.0;
+    double target_snr = 0.0;
+    string matrix = "flat";
+    DCTTransform transform = DCTTransform::DCT;
+    bool block_switching = false;
+    bool bad_option = false;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+        } else if (arg == "-o" && i + 1 < argc) {
+            output_dir = argv[++i];
+        } else if (arg == "-d") {
+            decode = true;
+        } else if (arg == "-p" && i + 3 < argc) {
+            block_size = atoi(argv[++i]);
+            num_coeffs = atoi(argv[++i]);
+            quant_factor = atoi(argv[++i]);
+        } else if (arg == "-c" && i + 1 < argc) {
+            string name = argv[++i];
+            if (name == "raw") coding = DCTCoding::RAW;
+            else if (name == "rice") coding = DCTCoding::RICE;
+            else if (name == "huffman") coding = DCTCoding::HUFFMAN;
+            else bad_option = true;
+        } else if (arg == "-e") {
+            eob = true;
+        } else if (arg == "-m") {
+            mid_side = true;
+        } else if (arg == "-i") {
+            seek_index = true;
+        } else if (arg == "-b" && i + 1 < argc) {
+            target_kbps = atof(argv[++i]);
+            if (target_kbps <= 0.0) bad_option = true;
+        } else if (arg == "-s" && i + 1 < argc) {
+            target_snr = atof(argv[++i]);
+            if (target_snr <= 0.0) bad_option = true;
+        } else if (arg == "-w" && i + 1 < argc) {
+            matrix = argv[++i];
+        } else if (arg == "-t" && i + 1 < argc) {
+            string name = argv[++i];
+            if (name == "dct") transform = DCTTransform::DCT;
+            else if (name == "mdct") transform = DCTTransform::MDCT_SINE;
+            else if (name == "mdct-kbd") transform = DCTTransform::MDCT_KBD;
+            else bad_option = true;
+        } else if (arg == "-a") {
+            block_switching = true;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    // Débito alvo e SNR alvo são alternativos (set_target_snr anula o débito)
+    if (target_kbps > 0.0 && target_snr > 0.0) bad_option = true;
+
+    // Verificar argumentos
+    if (inputs.empty() || output_dir.empty() || num_threads < 0 || bad_option ||
+        block_size <= 0 || num_coeffs <= 0 || quant_factor <= 0) {
+        cout << "\nUso: " << argv[0] << " [-d] [-j threads] [-p block_size num_coeffs quant_factor]" << endl;
+        cout << "       [-c raw|rice|huffman] [-e] [-m] [-i] [-b kbps | -s dB] [-w matriz] [-t transformada] [-a]" << endl;
+        cout << "       -o <dir_saída> <entrada>..." << endl;
+        cout << "\nEntradas: diretórios (todos os .wav, ou .dct com -d, recursivamente)," << endl;
+        cout << "          listas de ficheiros (.txt/.lst, um por linha) ou ficheiros" << endl;
+        cout << "\nOpções:" << endl;
+        cout << "  -d             - Descodificar .dct para .wav (default: codificar .wav)" << endl;
+        cout << "  -j threads     - Threads (default: 0 = todos os cores)" << endl;
+        cout << "  -p b k q       - Tamanho do bloco, coeficientes e fator de quantização" << endl;
+        cout << "                   (default: 512 256 2)" << endl;
+        cout << "  -c, -e, -m, -i, -b, -s, -w, -t, -a - Como no dct_encoder" << endl;
+        cout << "  -o dir         - Diretório de saída (mantém a estrutura dos diretórios)" << endl;
+        cout << "\nExemplos:" << endl;
+        cout << "  " << argv[0] << " -c rice -e -p 1024 256 10 -o catalogo_dct ../../../audio_files" << endl;
+        cout << "  " << argv[0] << " -d -o catalogo_wav catalogo_dct" << endl;
+        return 1;
+    }
+
+    // Pesos de uma matriz em ficheiro, lidos uma vez para todos os ficheiros
+    vector<double> weights;
+    if (matrix != "flat" && matrix != "perceptual" && !DCTCodec::read_quant_matrix(matrix, weights)) {
+        return 1;
+    }
+    
+    vector<BatchJob> jobs;
+    for (const auto& input : inputs) {
+        collect_jobs(input, decode ? ".dct" : ".wav", output_dir, decode ? ".wav" : ".dct", jobs);
+    }
+    if (jobs.empty()) {
+        cerr << "Nenhum ficheiro encontrado!" << endl;
+        return 1;
+    }
+    if (!unique_outputs(jobs)) {
+        return 1;
+    }
+
+    // Maiores primeiro: os últimos ficheiros a começar são os mais curtos
+    stable_sort(jobs.begin(), jobs.end(), [](const BatchJob& a, const BatchJob& b) { return a.size > b.size; });
+
+    ThreadPool pool(num_threads);
+    uintmax_t total_bytes = 0;
+    for (const auto& job : jobs) total_bytes += job.size;
+
+    cout << "\nFicheiros: " << jobs.size() << " (" << fixed << setprecision(1) << total_bytes / 1e6 << " MB)" << endl;
+    cout << "Modo: " << (decode ? "descodificar" : "codificar") << endl;
+    cout << "Threads: " << pool.size() << endl;
+    cout << endl;
+
+    mutex report_mutex;
+    size_t done = 0;
+    auto start = chrono::high_resolution_clock::now();
+
+    pool.parallel_for(jobs.size(), [&](size_t j) {
+        BatchJob& job = jobs[j];
+        auto t0 = chrono::high_resolution_clock::now();
+
+        error_code ec;
+        fs::create_directories(job.output.parent_path(), ec);
+
+        DCTCodec codec(block_size, num_coeffs, quant_factor);
+        codec.set_thread_pool(&pool);
+        codec.set_verbose(false);
+        codec.set_coding(coding);
+        codec.set_eob(eob);
+        codec.set_mid_side(mid_side);
+        codec.set_seek_index(seek_index);
+        codec.set_transform(transform);
+        codec.set_block_switching(block_switching);
+        if (target_kbps > 0.0) codec.set_target_bitrate(target_kbps);
+        if (target_snr > 0.0) codec.set_target_snr(target_snr);
+        if (matrix == "perceptual") codec.set_quant_matrix(DCTMatrix::PERCEPTUAL);
+        else codec.set_quant_matrix(weights);
+
+        job.ok = decode ? codec.decode(job.input.string(), job.output.string())
+                        : codec.encode(job.input.string(), job.output.string());
+        job.seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - t0).count();
+        job.audio = wav_duration(decode ? job.output : job.input);
+
+        lock_guard<mutex> lock(report_mutex);
+        done++;
+        cout << "[" << setw(to_string(jobs.size()).size()) << done << "/" << jobs.size() << "] "
+             << (job.ok ? "" : "ERRO ") << job.input.string() << " -> " << job.output.string()
+             << fixed << setprecision(2) << " (" << job.seconds << " s, "
+             << job.size / 1e6 / max(job.seconds, 1e-9) << " MB/s, "
+             << setprecision(0) << job.audio / max(job.seconds, 1e-9) << "x tempo real)" << endl;
+    });
+
+    double elapsed = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    double total_audio = 0.0;
+    int failed = 0;
+    for (const auto& job : jobs) {
+        total_audio += job.audio;
+        if (!job.ok) failed++;
+    }
+
+    cout << "\nConcluído em " << fixed << setprecision(2) << elapsed << " s: "
+         << total_bytes / 1e6 / max(elapsed, 1e-9) << " MB/s, "
+         << setprecision(0) << total_audio / max(elapsed, 1e-9) << "x tempo real";
+    if (failed > 0) {
+        cout << ", " << failed << " ficheiro(s) com erro";
+    }
+    cout << endl;
+
+    return failed > 0 ? 1 : 0;
+}
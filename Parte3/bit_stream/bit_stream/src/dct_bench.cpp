@@ -0,0 +1,175 @@
+//-------------------------------------------------------------------------------------------
+//
+// DCT Benchmark - Compara as implementações da transformada do DCTCodec
+// (NAIVE, MATRIX e FFT, em blocos por segundo para DCT + IDCT) e a MDCT
+// (tramas por segundo para MDCT + IMDCT, pela FFT de N/2 pontos)
+//
+//-------------------------------------------------------------------------------------------
+
+#include "dct_codec.h"
+#include "dct_kernels.h"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+
+using namespace std;
+
+/**
+ * @brief Resultado de uma medição
+ */
+struct BenchResult {
+    double blocks_per_second;
+    vector<double> coeffs;      // Coeficientes do primeiro bloco (para comparação)
+};
+
+/**
+ * @brief Mede quantos blocos por segundo uma implementação transforma (DCT + IDCT)
+ * @param block_size Tamanho do bloco
+ * @param engine Implementação a usar
+ * @param blocks Blocos de teste
+ * @param min_time Tempo mínimo de medição em segundos
+ */
+BenchResult bench_engine(int block_size, DCTEngine engine,
+                         const vector<vector<short>>& blocks, double min_time) {
+    DCTCodec codec(block_size, block_size, 1);
+    codec.set_engine(engine);
+
+    BenchResult result;
+    result.coeffs = codec.apply_dct(blocks[0]);
+
+    size_t count = 0;
+    long checksum = 0;
+    auto start = chrono::high_resolution_clock::now();
+    double elapsed = 0.0;
+
+    while (elapsed < min_time) {
+        for (const auto& block : blocks) {
+            vector<short> out = codec.apply_idct(codec.apply_dct(block));
+            checksum += out[0];
+            count++;
+        }
+        elapsed = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    }
+
+    // Evitar que o compilador elimine o ciclo
+    if (checksum == 42) cout << "";
+
+    result.blocks_per_second = count / elapsed;
+    return result;
+}
+
+/**
+ * @brief Mede quantas tramas por segundo a MDCT transforma (MDCT + IMDCT, janela
+ *        seno) e compara a primeira trama com a definição direta
+ * @param frames Tramas de teste (2N amostras cada)
+ * @param max_diff Maior diferença face à soma direta
+ */
+double bench_mdct(int block_size, const vector<vector<short>>& frames, double min_time, double& max_diff) {
+    DCTCodec codec(block_size, block_size, 1);
+    codec.set_transform(DCTTransform::MDCT_SINE);
+
+    // X[k] = sqrt(2/N) sum w[n] x[n] cos(π/N (n + 1/2 + N/2)(k + 1/2))
+    const double pi = 3.14159265358979323846;
+    int N = block_size;
+    vector<double> coeffs = codec.apply_mdct(frames[0]);
+    max_diff = 0.0;
+    for (int k = 0; k < N; k++) {
+        double sum = 0.0;
+        for (int n = 0; n < 2 * N; n++) {
+            double w = sin(pi * (n + 0.5) / (2.0 * N));
+            sum += w * frames[0][n] * cos(pi / N * (n + 0.5 + N / 2.0) * (k + 0.5));
+        }
+        max_diff = max(max_diff, fabs(sqrt(2.0 / N) * sum - coeffs[k]));
+    }
+
+    size_t count = 0;
+    double checksum = 0.0;
+    auto start = chrono::high_resolution_clock::now();
+    double elapsed = 0.0;
+
+    while (elapsed < min_time) {
+        for (const auto& frame : frames) {
+            vector<double> out = codec.apply_imdct(codec.apply_mdct(frame));
+            checksum += out[0];
+            count++;
+        }
+        elapsed = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    }
+
+    if (checksum == 42.0) cout << "";
+
+    return count / elapsed;
+}
+
+int main(int argc, char* argv[]) {
+    double min_time = (argc > 1) ? atof(argv[1]) : 0.5;
+
+    cout << "DCT Benchmark (DCT + IDCT por bloco)" << endl;
+    cout << "====================================" << endl;
+    cout << "Kernels MATRIX: " << dct_kernels().name << endl;
+    cout << fixed;
+    cout << setw(8) << "Bloco"
+         << setw(14) << "NAIVE blk/s"
+         << setw(14) << "MATRIX blk/s"
+         << setw(14) << "FFT blk/s"
+         << setw(12) << "FFT/NAIVE"
+         << setw(12) << "FFT/MATRIX"
+         << setw(12) << "Max |dif|"
+         << setw(14) << "MDCT trm/s"
+         << setw(12) << "MDCT |dif|" << endl;
+
+    for (int block_size : {64, 128, 256, 512, 1024, 2048}) {
+        // Sinal de teste: soma de sinusoides com ruído
+        vector<vector<short>> blocks(8, vector<short>(block_size));
+        unsigned seed = 12345;
+        for (size_t b = 0; b < blocks.size(); b++) {
+            for (int n = 0; n < block_size; n++) {
+                seed = seed * 1103515245 + 12345;
+                double t = static_cast<double>(b * block_size + n);
+                double v = 8000.0 * sin(0.01 * t) + 3000.0 * sin(0.37 * t) + ((seed >> 16) % 2000) - 1000.0;
+                blocks[b][n] = static_cast<short>(v);
+            }
+        }
+
+        // A versão NAIVE é lenta: menos tempo de medição nos blocos grandes
+        BenchResult naive = bench_engine(block_size, DCTEngine::NAIVE, blocks, min_time / 4);
+        BenchResult matrix = bench_engine(block_size, DCTEngine::MATRIX, blocks, min_time);
+        BenchResult fast = bench_engine(block_size, DCTEngine::FFT, blocks, min_time);
+
+        // Tramas MDCT: pares de blocos consecutivos do mesmo sinal
+        vector<vector<short>> frames;
+        for (size_t b = 0; b + 1 < blocks.size(); b++) {
+            frames.push_back(blocks[b]);
+            frames.back().insert(frames.back().end(), blocks[b + 1].begin(), blocks[b + 1].end());
+        }
+        double mdct_diff = 0.0;
+        double mdct_rate = bench_mdct(block_size, frames, min_time, mdct_diff);
+
+        double max_diff = 0.0;
+        for (int k = 0; k < block_size; k++) {
+            max_diff = max(max_diff, fabs(naive.coeffs[k] - fast.coeffs[k]));
+            max_diff = max(max_diff, fabs(naive.coeffs[k] - matrix.coeffs[k]));
+        }
+
+        cout << setw(8) << block_size
+             << setprecision(0)
+             << setw(14) << naive.blocks_per_second
+             << setw(14) << matrix.blocks_per_second
+             << setw(14) << fast.blocks_per_second
+             << setprecision(2)
+             << setw(11) << fast.blocks_per_second / naive.blocks_per_second << "x"
+             << setw(11) << fast.blocks_per_second / matrix.blocks_per_second << "x"
+             << scientific
+             << setw(12) << max_diff
+             << fixed << setprecision(0)
+             << setw(14) << mdct_rate
+             << scientific << setprecision(2)
+             << setw(12) << mdct_diff
+             << fixed << endl;
+    }
+
+    return 0;
+}
@@ -6,11 +6,22 @@
 //-------------------------------------------------------------------------------------------
 
 #include "dct_codec.h"
+#include "dct_kernels.h"
 #include "bit_stream.h"
+#include "bit_buffer.h"
+#include "thread_pool.h"
+#include "rice.h"
+#include "huffman.h"
 #include <fstream>
 #include <iostream>
 #include <cmath>
 #include <cstring>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
 
 using namespace std;
 
@@ -23,7 +34,31 @@ const double PI = 3.14159265358979323846;
 DCTCodec::DCTCodec(int block_size, int num_coeffs, int quantization_factor)
     : m_block_size(block_size), 
       m_num_coeffs(num_coeffs), 
-      m_quantization_factor(quantization_factor) {
+      m_quantization_factor(quantization_factor),
+      m_engine(DCTEngine::AUTO),
+      m_transform(DCTTransform::DCT),
+      m_coding(DCTCoding::RAW),
+      m_eob(false),
+      m_segment_blocks(DCT_SEGMENT_BLOCKS),
+      m_num_channels(1),
+      m_mid_side(false),
+      m_seek_index(false),
+      m_verbose(true),
+      m_segment_step(false),
+      m_target_kbps(0.0),
+      m_target_snr(0.0),
+      m_block_switching(false),
+      m_matrix(DCTMatrix::FLAT),
+      m_sample_rate(0),
+      m_total_samples(0),
+      m_index_offset(0),
+      m_basis(nullptr),
+      m_fft_plan(nullptr),
+      m_mdct_plan(nullptr),
+      m_short_basis(nullptr),
+      m_short_fft_plan(nullptr),
+      m_num_threads(1),
+      m_pool(nullptr) {
     
     // Validação dos parâmetros
     if (m_num_coeffs > m_block_size) {
@@ -31,12 +66,221 @@ DCTCodec::DCTCodec(int block_size, int num_coeffs, int quantization_factor)
     }
 }
 
+DCTCodec::~DCTCodec() = default;
+
+//-------------------------------------------------------------------------------------------
+// Paralelismo
+//-------------------------------------------------------------------------------------------
+void DCTCodec::set_num_threads(int num_threads) {
+    m_own_pool.reset();
+    m_pool = nullptr;
+    m_num_threads = 1;
+    
+    if (num_threads != 1) {
+        m_own_pool = make_unique<ThreadPool>(num_threads);
+        m_num_threads = m_own_pool->size();
+        if (m_num_threads == 1) m_own_pool.reset();
+        m_pool = m_own_pool.get();
+    }
+}
+
+void DCTCodec::set_thread_pool(ThreadPool* pool) {
+    m_own_pool.reset();
+    m_pool = pool;
+    m_num_threads = pool ? pool->size() : 1;
+}
+
+void DCTCodec::run_parallel(size_t count, const function<void(size_t)>& fn) {
+    if (m_pool) {
+        m_pool->parallel_for(count, fn);
+    } else {
+        for (size_t i = 0; i < count; i++) fn(i);
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// Cache de tabelas por tamanho de bloco
+//
+// As tabelas são construídas na primeira utilização de cada tamanho e partilhadas
+// por todas as chamadas e instâncias do codec no processo (nunca são libertadas).
+//-------------------------------------------------------------------------------------------
+struct AlignedFree {
+    void operator()(double* p) const { ::operator delete[](p, align_val_t{64}); }
+};
+
+struct DCTBasis {
+    int size;                                   // N
+    int stride;                                 // Linha com N valores arredondado a 8 doubles
+    unique_ptr<double[], AlignedFree> table;    // table[k*stride + n] = alpha_k cos(πk(2n+1)/(2N))
+    
+    const double* row(int k) const { return table.get() + static_cast<size_t>(k) * stride; }
+};
+
+struct FFTPlan {
+    int size;                                   // N
+    vector<int> bitrev;                         // Permutação bit-reversal
+    vector<complex<double>> twiddles;           // exp(-2πij/N), j < N/2
+    vector<complex<double>> dct_twiddles;       // exp(-iπk/(2N)), k < N
+};
+
+static mutex tables_mutex;
+
+static const DCTBasis* get_basis(int N) {
+    static map<int, unique_ptr<DCTBasis>> cache;
+    lock_guard<mutex> lock(tables_mutex);
+    
+    unique_ptr<DCTBasis>& entry = cache[N];
+    if (!entry) {
+        auto basis = make_unique<DCTBasis>();
+        basis->size = N;
+        basis->stride = (N + 7) & ~7;   // Cada linha alinhada a 64 bytes
+        
+        size_t bytes = static_cast<size_t>(N) * basis->stride * sizeof(double);
+        basis->table.reset(static_cast<double*>(::operator new[](bytes, align_val_t{64})));
+        
+        for (int k = 0; k < N; k++) {
+            double alpha = (k == 0) ? sqrt(1.0 / N) : sqrt(2.0 / N);
+            double* row = basis->table.get() + static_cast<size_t>(k) * basis->stride;
+            for (int n = 0; n < basis->stride; n++) {
+                row[n] = (n < N) ? alpha * cos(PI * k * (2.0 * n + 1.0) / (2.0 * N)) : 0.0;
+            }
+        }
+        entry = move(basis);
+    }
+    return entry.get();
+}
+
+static const FFTPlan* get_fft_plan(int N) {
+    static map<int, unique_ptr<FFTPlan>> cache;
+    lock_guard<mutex> lock(tables_mutex);
+    
+    unique_ptr<FFTPlan>& entry = cache[N];
+    if (!entry) {
+        auto plan = make_unique<FFTPlan>();
+        plan->size = N;
+        
+        int log2n = 0;
+        while ((1 << log2n) < N) log2n++;
+        
+        plan->bitrev.resize(N);
+        for (int i = 0; i < N; i++) {
+            int r = 0;
+            for (int b = 0; b < log2n; b++) {
+                r |= ((i >> b) & 1) << (log2n - 1 - b);
+            }
+            plan->bitrev[i] = r;
+        }
+        
+        plan->twiddles.resize(N / 2);
+        for (int j = 0; j < N / 2; j++) {
+            plan->twiddles[j] = polar(1.0, -2.0 * PI * j / N);
+        }
+        
+        plan->dct_twiddles.resize(N);
+        for (int k = 0; k < N; k++) {
+            plan->dct_twiddles[k] = polar(1.0, -PI * k / (2.0 * N));
+        }
+        entry = move(plan);
+    }
+    return entry.get();
+}
+
+//-------------------------------------------------------------------------------------------
+// FFT radix-2 iterativa (in-place)
+//-------------------------------------------------------------------------------------------
+static void fft(const FFTPlan& plan, vector<complex<double>>& data, bool inverse) {
+    int N = plan.size;
+    
+    for (int i = 0; i < N; i++) {
+        int j = plan.bitrev[i];
+        if (i < j) swap(data[i], data[j]);
+    }
+    
+    // Borboletas (produtos complexos escritos à mão para evitar __muldc3)
+    for (int len = 2; len <= N; len <<= 1) {
+        int half = len / 2;
+        int step = N / len;
+        for (int start = 0; start < N; start += len) {
+            for (int j = 0; j < half; j++) {
+                const complex<double>& w = plan.twiddles[j * step];
+                double wr = w.real();
+                double wi = inverse ? -w.imag() : w.imag();
+                
+                complex<double>& a = data[start + j];
+                complex<double>& b = data[start + j + half];
+                double br = b.real() * wr - b.imag() * wi;
+                double bi = b.real() * wi + b.imag() * wr;
+                
+                b = complex<double>(a.real() - br, a.imag() - bi);
+                a = complex<double>(a.real() + br, a.imag() + bi);
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// Escolha da implementação para o tamanho de bloco atual
+//-------------------------------------------------------------------------------------------
+static bool is_power_of_two(int n) {
+    return n >= 2 && (n & (n - 1)) == 0;
+}
+
+static const MDCTPlan* get_mdct_plan(int N, DCTTransform transform);
+
+DCTEngine DCTCodec::resolve_engine(int N) const {
+    DCTEngine engine = m_engine;
+    
+    if (engine == DCTEngine::AUTO) {
+        engine = is_power_of_two(N) ? DCTEngine::FFT : DCTEngine::MATRIX;
+    }
+    if (engine == DCTEngine::FFT && !is_power_of_two(N)) {
+        engine = DCTEngine::MATRIX;
+    }
+    if (engine == DCTEngine::MATRIX && N > DCT_MATRIX_MAX_SIZE) {
+        engine = DCTEngine::NAIVE;
+    }
+    return engine;
+}
+
+void DCTCodec::prepare_transform() {
+    if (is_mdct()) {
+        m_mdct_plan = get_mdct_plan(m_block_size, m_transform);
+        return;
+    }
+    basis_for_size(m_block_size);
+    fft_plan_for_size(m_block_size);
+    if (m_block_switching && m_block_size % DCT_SHORT_BLOCKS == 0) {
+        basis_for_size(m_block_size / DCT_SHORT_BLOCKS);
+        fft_plan_for_size(m_block_size / DCT_SHORT_BLOCKS);
+    }
+}
+
+const DCTBasis* DCTCodec::basis_for_size(int N) {
+    const DCTBasis*& basis = (N == m_block_size) ? m_basis : m_short_basis;
+    if (resolve_engine(N) == DCTEngine::MATRIX && (!basis || basis->size != N)) basis = get_basis(N);
+    return basis;
+}
+
+const FFTPlan* DCTCodec::fft_plan_for_size(int N) {
+    const FFTPlan*& plan = (N == m_block_size) ? m_fft_plan : m_short_fft_plan;
+    if (resolve_engine(N) == DCTEngine::FFT && (!plan || plan->size != N)) plan = get_fft_plan(N);
+    return plan;
+}
+
 //-------------------------------------------------------------------------------------------
 // DCT - Transformada Discreta do Cosseno
 //-------------------------------------------------------------------------------------------
 vector<double> DCTCodec::apply_dct(const vector<short>& samples) {
-    vector<double> coeffs(m_block_size, 0.0);
-    int N = m_block_size;
+    switch (resolve_engine(static_cast<int>(samples.size()))) {
+        case DCTEngine::FFT:    return apply_dct_fft(samples);
+        case DCTEngine::MATRIX: return apply_dct_matrix(samples);
+        default:                return apply_dct_naive(samples);
+    }
+}
+
+vector<double> DCTCodec::apply_dct_naive(const vector<short>& samples) const {
+    int N = static_cast<int>(samples.size());
+    vector<double> coeffs(N, 0.0);
     
     for (int k = 0; k < N; k++) {
         double sum = 0.0;
@@ -52,12 +296,81 @@ vector<double> DCTCodec::apply_dct(const vector<short>& samples) {
     return coeffs;
 }
 
+//-------------------------------------------------------------------------------------------
+// DCT como produto pela matriz de cossenos: X[k] = <linha k, x>
+//-------------------------------------------------------------------------------------------
+vector<double> DCTCodec::apply_dct_matrix(const vector<short>& samples) {
+    int N = static_cast<int>(samples.size());
+    const DCTBasis& basis = *basis_for_size(N);
+    
+    vector<double> x(samples.begin(), samples.end());
+    vector<double> coeffs(N);
+    const DCTKernels& kernels = dct_kernels();
+    
+    for (int k = 0; k < N; k++) {
+        coeffs[k] = kernels.dot(basis.row(k), x.data(), N);
+    }
+    
+    return coeffs;
+}
+
+//-------------------------------------------------------------------------------------------
+// DCT-II pelo algoritmo de Makhoul:
+//   v[n] = x[2n], v[N-1-n] = x[2n+1]
+//   X[k] = Re(FFT(v)[k] * exp(-iπk/(2N)))
+//-------------------------------------------------------------------------------------------
+vector<double> DCTCodec::apply_dct_fft(const vector<short>& samples) {
+    int N = static_cast<int>(samples.size());
+    const FFTPlan& plan = *fft_plan_for_size(N);
+    
+    vector<complex<double>> v(N);
+    for (int n = 0; n < N / 2; n++) {
+        v[n] = samples[2 * n];
+        v[N - 1 - n] = samples[2 * n + 1];
+    }
+    
+    fft(plan, v, false);
+    
+    vector<double> coeffs(N);
+    double alpha0 = sqrt(1.0 / N);
+    double alpha = sqrt(2.0 / N);
+    for (int k = 0; k < N; k++) {
+        const complex<double>& w = plan.dct_twiddles[k];
+        double re = v[k].real() * w.real() - v[k].imag() * w.imag();
+        coeffs[k] = ((k == 0) ? alpha0 : alpha) * re;
+    }
+    
+    return coeffs;
+}
+
 //-------------------------------------------------------------------------------------------
 // IDCT - Transformada Inversa
 //-------------------------------------------------------------------------------------------
 vector<short> DCTCodec::apply_idct(const vector<double>& coeffs) {
-    vector<short> samples(m_block_size, 0);
-    int N = m_block_size;
+    int N = static_cast<int>(coeffs.size());
+    vector<double> values;
+    switch (resolve_engine(N)) {
+        case DCTEngine::FFT:    values = apply_idct_fft(coeffs); break;
+        case DCTEngine::MATRIX: values = apply_idct_matrix(coeffs); break;
+        default:                values = apply_idct_naive(coeffs); break;
+    }
+    
+    vector<short> samples(N, 0);
+    for (int n = 0; n < N; n++) {
+        double sum = values[n];
+        
+        // Limitar valores ao intervalo de 16-bit signed
+        if (sum > 32767.0) sum = 32767.0;
+        if (sum < -32768.0) sum = -32768.0;
+        samples[n] = static_cast<short>(round(sum));
+    }
+    
+    return samples;
+}
+
+vector<double> DCTCodec::apply_idct_naive(const vector<double>& coeffs) const {
+    int N = static_cast<int>(coeffs.size());
+    vector<double> values(N, 0.0);
     
     for (int n = 0; n < N; n++) {
         double sum = 0.0;
@@ -65,28 +378,363 @@ vector<short> DCTCodec::apply_idct(const vector<double>& coeffs) {
             double alpha = (k == 0) ? sqrt(1.0 / N) : sqrt(2.0 / N);
             sum += alpha * coeffs[k] * cos(PI * k * (2.0 * n + 1.0) / (2.0 * N));
         }
+        values[n] = sum;
+    }
+    
+    return values;
+}
+
+//-------------------------------------------------------------------------------------------
+// IDCT com a mesma matriz (transposta): x += X[k] * linha k, saltando os
+// coeficientes nulos (todos os k >= num_coeffs e os que a quantização anulou)
+//-------------------------------------------------------------------------------------------
+vector<double> DCTCodec::apply_idct_matrix(const vector<double>& coeffs) {
+    int N = static_cast<int>(coeffs.size());
+    const DCTBasis& basis = *basis_for_size(N);
+    
+    vector<double> values(N, 0.0);
+    const DCTKernels& kernels = dct_kernels();
+    
+    for (int k = 0; k < N; k++) {
+        if (coeffs[k] != 0.0) {
+            kernels.axpy(coeffs[k], basis.row(k), values.data(), N);
+        }
+    }
+    
+    return values;
+}
+
+//-------------------------------------------------------------------------------------------
+// DCT-III (inversa da DCT-II ortonormal) pela FFT:
+//   Z[0] = X[0]/sqrt(N), Z[k] = X[k]/sqrt(2N)
+//   V[k] = (Z[k] - i Z[N-k]) * exp(iπk/(2N)), v = IFFT(V) (sem 1/N)
+//   x[2n] = Re v[n], x[2n+1] = Re v[N-1-n]
+//-------------------------------------------------------------------------------------------
+vector<double> DCTCodec::apply_idct_fft(const vector<double>& coeffs) {
+    int N = static_cast<int>(coeffs.size());
+    const FFTPlan& plan = *fft_plan_for_size(N);
+    
+    double scale0 = sqrt(1.0 / N);
+    double scale = sqrt(1.0 / (2.0 * N));
+    
+    vector<complex<double>> V(N);
+    for (int k = 0; k < N; k++) {
+        double zr = coeffs[k] * ((k == 0) ? scale0 : scale);
+        double zi = (k == 0) ? 0.0 : -coeffs[N - k] * scale;
         
-        // Limitar valores ao intervalo de 16-bit signed
-        if (sum > 32767.0) sum = 32767.0;
-        if (sum < -32768.0) sum = -32768.0;
-        samples[n] = static_cast<short>(round(sum));
+        // Multiplicar por exp(iπk/(2N)) = conj(dct_twiddles[k])
+        const complex<double>& w = plan.dct_twiddles[k];
+        V[k] = complex<double>(zr * w.real() + zi * w.imag(), zi * w.real() - zr * w.imag());
+    }
+    
+    fft(plan, V, true);
+    
+    vector<double> values(N);
+    for (int n = 0; n < N / 2; n++) {
+        values[2 * n] = V[n].real();
+        values[2 * n + 1] = V[N - 1 - n].real();
+    }
+    
+    return values;
+}
+
+//-------------------------------------------------------------------------------------------
+// Blocos curtos: DCT de cada sub-bloco, coeficiente j do sub-bloco s na posição
+// j * DCT_SHORT_BLOCKS + s
+//-------------------------------------------------------------------------------------------
+vector<double> DCTCodec::apply_short_dct(const vector<short>& samples) {
+    int M = m_block_size / DCT_SHORT_BLOCKS;
+    vector<double> coeffs(m_block_size);
+    vector<short> sub_block(M);
+    
+    for (int s = 0; s < DCT_SHORT_BLOCKS; s++) {
+        copy(samples.begin() + s * M, samples.begin() + (s + 1) * M, sub_block.begin());
+        vector<double> sub_coeffs = apply_dct(sub_block);
+        for (int j = 0; j < M; j++) {
+            coeffs[j * DCT_SHORT_BLOCKS + s] = sub_coeffs[j];
+        }
     }
+    return coeffs;
+}
+
+vector<short> DCTCodec::apply_short_idct(const vector<double>& coeffs) {
+    int M = m_block_size / DCT_SHORT_BLOCKS;
+    vector<short> samples(m_block_size);
+    vector<double> sub_coeffs(M);
     
+    for (int s = 0; s < DCT_SHORT_BLOCKS; s++) {
+        for (int j = 0; j < M; j++) {
+            sub_coeffs[j] = coeffs[j * DCT_SHORT_BLOCKS + s];
+        }
+        vector<short> sub_block = apply_idct(sub_coeffs);
+        copy(sub_block.begin(), sub_block.end(), samples.begin() + s * M);
+    }
     return samples;
 }
 
+//-------------------------------------------------------------------------------------------
+// MDCT
+//
+// Trama de 2N amostras z = janela * x = (a, b, c, d), quartos de N/2 amostras:
+//   MDCT(z) = DCT-IV(-c_r - d, a - b_r)        (_r: quarto invertido)
+//   IMDCT(X) = janela * (u2, -u2_r, -u1_r, -u1), com (u1, u2) = DCT-IV(X)
+// Com uma janela que cumpre w[n]² + w[n+N]² = 1 (seno, KBD), somar a segunda metade
+// de uma trama com a primeira metade da seguinte reconstrói o bloco comum.
+//-------------------------------------------------------------------------------------------
+struct MDCTPlan {
+    int size;                                   // N (tramas de 2N amostras)
+    DCTTransform transform;                     // Janela
+    vector<double> window;                      // 2N pesos
+    const FFTPlan* fft;                         // FFT de N/2 pontos (nullptr sem FFT)
+    vector<complex<double>> pre_twiddles;       // exp(-iπn/N), n < N/2
+    vector<complex<double>> post_twiddles;      // exp(-iπ(k+1/4)/N), k < N/2
+    vector<double> basis;                       // cos(π(n+1/2)(k+1/2)/N) sem FFT
+};
+
+// Função de Bessel modificada I0 (série de potências)
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 500 && term > 1e-16 * sum; k++) {
+        double t = x / (2.0 * k);
+        term *= t * t;
+        sum += term;
+    }
+    return sum;
+}
+
+static const MDCTPlan* get_mdct_plan(int N, DCTTransform transform) {
+    static map<pair<int, DCTTransform>, unique_ptr<MDCTPlan>> cache;
+    
+    // A FFT vem da sua cache antes de se fechar o mutex (partilhado pelas duas)
+    const FFTPlan* fft = (N >= 4 && is_power_of_two(N)) ? get_fft_plan(N / 2) : nullptr;
+    lock_guard<mutex> lock(tables_mutex);
+    
+    unique_ptr<MDCTPlan>& entry = cache[{ N, transform }];
+    if (!entry) {
+        auto plan = make_unique<MDCTPlan>();
+        plan->size = N;
+        plan->transform = transform;
+        plan->fft = fft;
+        
+        plan->window.resize(2 * N);
+        if (transform == DCTTransform::MDCT_KBD) {
+            // Soma cumulativa de uma janela de Kaiser de N+1 pontos, normalizada
+            vector<double> kaiser(N + 1);
+            double total = 0.0;
+            for (int j = 0; j <= N; j++) {
+                double r = 2.0 * j / N - 1.0;
+                kaiser[j] = bessel_i0(PI * DCT_KBD_ALPHA * sqrt(max(0.0, 1.0 - r * r)));
+                total += kaiser[j];
+            }
+            double sum = 0.0;
+            for (int n = 0; n < N; n++) {
+                sum += kaiser[n];
+                plan->window[n] = plan->window[2 * N - 1 - n] = sqrt(sum / total);
+            }
+        } else {
+            for (int n = 0; n < 2 * N; n++) {
+                plan->window[n] = sin(PI * (n + 0.5) / (2.0 * N));
+            }
+        }
+        
+        if (fft) {
+            plan->pre_twiddles.resize(N / 2);
+            plan->post_twiddles.resize(N / 2);
+            for (int n = 0; n < N / 2; n++) {
+                plan->pre_twiddles[n] = polar(1.0, -PI * n / N);
+                plan->post_twiddles[n] = polar(1.0, -PI * (n + 0.25) / N);
+            }
+        } else if (N <= DCT_MATRIX_MAX_SIZE) {
+            plan->basis.resize(static_cast<size_t>(N) * N);
+            for (int k = 0; k < N; k++) {
+                for (int n = 0; n < N; n++) {
+                    plan->basis[static_cast<size_t>(k) * N + n] = cos(PI * (n + 0.5) * (k + 0.5) / N);
+                }
+            }
+        }
+        entry = move(plan);
+    }
+    return entry.get();
+}
+
+void DCTCodec::apply_dct4(const double* in, double* out) {
+    int N = m_block_size;
+    if (!m_mdct_plan || m_mdct_plan->size != N || m_mdct_plan->transform != m_transform) {
+        m_mdct_plan = get_mdct_plan(N, m_transform);
+    }
+    if (m_mdct_plan->fft) {
+        dct4_fft(in, out);
+    } else {
+        dct4_matrix(in, out);
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// DCT-IV pela FFT de N/2 pontos:
+//   z[n] = (u[2n] + i u[N-1-2n]) exp(-iπn/N)
+//   W[k] = FFT(z)[k] exp(-iπ(k+1/4)/N)
+//   X[2k] = Re W[k], X[N-1-2k] = -Im W[k]
+//-------------------------------------------------------------------------------------------
+void DCTCodec::dct4_fft(const double* in, double* out) {
+    int N = m_block_size;
+    int H = N / 2;
+    const MDCTPlan& plan = *m_mdct_plan;
+    
+    vector<complex<double>> z(H);
+    for (int n = 0; n < H; n++) {
+        double re = in[2 * n];
+        double im = in[N - 1 - 2 * n];
+        const complex<double>& w = plan.pre_twiddles[n];
+        z[n] = complex<double>(re * w.real() - im * w.imag(), re * w.imag() + im * w.real());
+    }
+    
+    fft(*plan.fft, z, false);
+    
+    double scale = sqrt(2.0 / N);
+    for (int k = 0; k < H; k++) {
+        const complex<double>& w = plan.post_twiddles[k];
+        double re = z[k].real() * w.real() - z[k].imag() * w.imag();
+        double im = z[k].real() * w.imag() + z[k].imag() * w.real();
+        out[2 * k] = scale * re;
+        out[N - 1 - 2 * k] = -scale * im;
+    }
+}
+
+void DCTCodec::dct4_matrix(const double* in, double* out) {
+    int N = m_block_size;
+    const MDCTPlan& plan = *m_mdct_plan;
+    double scale = sqrt(2.0 / N);
+    
+    if (plan.basis.empty()) {
+        for (int k = 0; k < N; k++) {
+            double sum = 0.0;
+            for (int n = 0; n < N; n++) {
+                sum += in[n] * cos(PI * (n + 0.5) * (k + 0.5) / N);
+            }
+            out[k] = scale * sum;
+        }
+        return;
+    }
+    
+    const DCTKernels& kernels = dct_kernels();
+    for (int k = 0; k < N; k++) {
+        out[k] = scale * kernels.dot(plan.basis.data() + static_cast<size_t>(k) * N, in, N);
+    }
+}
+
+vector<double> DCTCodec::apply_mdct(const vector<short>& samples) {
+    int N = m_block_size;
+    int H = N / 2;
+    if (!m_mdct_plan || m_mdct_plan->size != N || m_mdct_plan->transform != m_transform) {
+        m_mdct_plan = get_mdct_plan(N, m_transform);
+    }
+    const vector<double>& w = m_mdct_plan->window;
+    
+    // Dobrar a trama com janela em N valores
+    vector<double> u(N);
+    for (int n = 0; n < H; n++) {
+        u[n] = -w[N + H - 1 - n] * samples[N + H - 1 - n] - w[N + H + n] * samples[N + H + n];
+        u[H + n] = w[n] * samples[n] - w[N - 1 - n] * samples[N - 1 - n];
+    }
+    
+    vector<double> coeffs(N);
+    apply_dct4(u.data(), coeffs.data());
+    return coeffs;
+}
+
+vector<double> DCTCodec::apply_imdct(const vector<double>& coeffs) {
+    int N = m_block_size;
+    int H = N / 2;
+    vector<double> u(N);
+    apply_dct4(coeffs.data(), u.data());
+    
+    // Desdobrar em 2N valores e aplicar a janela
+    const vector<double>& w = m_mdct_plan->window;
+    vector<double> values(2 * N);
+    for (int n = 0; n < H; n++) {
+        values[n] = w[n] * u[H + n];
+        values[H + n] = -w[H + n] * u[N - 1 - n];
+        values[N + n] = -w[N + n] * u[H - 1 - n];
+        values[N + H + n] = -w[N + H + n] * u[n];
+    }
+    return values;
+}
+
 //-------------------------------------------------------------------------------------------
 // Quantização
 //-------------------------------------------------------------------------------------------
-int DCTCodec::quantize(double coeff) {
-    return static_cast<int>(round(coeff / m_quantization_factor));
+int DCTCodec::quantize(double coeff, double step) const {
+    return static_cast<int>(round(coeff / step));
 }
 
 //-------------------------------------------------------------------------------------------
 // Dequantização
 //-------------------------------------------------------------------------------------------
-double DCTCodec::dequantize(int quantized_coeff) {
-    return quantized_coeff * m_quantization_factor;
+double DCTCodec::dequantize(int quantized_coeff, double step) const {
+    return quantized_coeff * step;
+}
+
+//-------------------------------------------------------------------------------------------
+// Matriz de quantização
+//-------------------------------------------------------------------------------------------
+bool DCTCodec::read_quant_matrix(const string& filename, vector<double>& weights) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Erro: não foi possível abrir " << filename << endl;
+        return false;
+    }
+    
+    weights.clear();
+    string line;
+    while (getline(file, line)) {
+        istringstream fields(line.substr(0, line.find('#')));
+        string field;
+        while (fields >> field) {
+            char* end = nullptr;
+            double weight = strtod(field.c_str(), &end);
+            if (*end != '\0' || weight * DCT_WEIGHT_SCALE < 0.5 ||
+                weight * DCT_WEIGHT_SCALE >= DCT_WEIGHT_MAX + 0.5) {
+                cerr << "Erro: peso inválido em " << filename << ": " << field << endl;
+                return false;
+            }
+            weights.push_back(weight);
+        }
+    }
+    if (weights.empty()) {
+        cerr << "Erro: " << filename << " não tem pesos" << endl;
+        return false;
+    }
+    return true;
+}
+
+void DCTCodec::build_weights(int sample_rate) {
+    m_weights.clear();
+    if (m_matrix == DCTMatrix::CUSTOM) {
+        for (int k = 0; k < m_num_coeffs; k++) {
+            double weight = m_matrix_table[min<size_t>(k, m_matrix_table.size() - 1)];
+            m_weights.push_back(static_cast<int>(round(weight * DCT_WEIGHT_SCALE)));
+        }
+    } else if (m_matrix == DCTMatrix::PERCEPTUAL) {
+        // Limiar absoluto de audição (Terhardt) em dB; abaixo do mínimo (~3.3 kHz) o
+        // peso fica 1, porque os graves têm quase sempre energia muito acima do limiar
+        auto ath = [](double hz) {
+            double f = max(hz, 20.0) / 1000.0;
+            return 3.64 * pow(f, -0.8) - 6.5 * exp(-0.6 * (f - 3.3) * (f - 3.3)) + 1e-3 * pow(f, 4);
+        };
+        double ath_min = ath(3300.0);
+        for (int k = 0; k < m_num_coeffs; k++) {
+            double hz = k * 0.5 * sample_rate / m_block_size;   // Frequência do coeficiente k
+            double rise = (hz > 3300.0) ? ath(hz) - ath_min : 0.0;
+            double weight = pow(10.0, rise / 40.0);             // Metade da subida em dB
+            m_weights.push_back(clamp(static_cast<int>(round(weight * DCT_WEIGHT_SCALE)),
+                                      1, DCT_WEIGHT_MAX));
+        }
+    }
+    
+    m_coeff_scale.assign(m_num_coeffs, 1.0);
+    for (size_t k = 0; k < m_weights.size(); k++) {
+        m_coeff_scale[k] = static_cast<double>(m_weights[k]) / DCT_WEIGHT_SCALE;
+    }
 }
 
 //-------------------------------------------------------------------------------------------
@@ -99,8 +747,8 @@ double DCTCodec::test_roundtrip(const vector<short>& samples) {
     // Quantizar todos os coeficientes
     vector<double> quantized_coeffs(m_block_size, 0.0);
     for (int k = 0; k < m_block_size; k++) {
-        int q = quantize(dct_coeffs[k]);
-        quantized_coeffs[k] = dequantize(q);
+        int q = quantize(dct_coeffs[k], m_quantization_factor);
+        quantized_coeffs[k] = dequantize(q, m_quantization_factor);
     }
     
     // Aplicar IDCT
@@ -127,141 +775,521 @@ double DCTCodec::test_roundtrip(const vector<short>& samples) {
 }
 
 //-------------------------------------------------------------------------------------------
-// Leitura de ficheiro WAV
+// Contextos de Rice: 0 para o DC, 1 + banda de oitava para o coeficiente k, e
+// depois os do número de coeficientes até ao EOB e dos comprimentos das corridas
 //-------------------------------------------------------------------------------------------
-bool read_wav_file(const string& filename, WAVHeader& header, vector<short>& samples) {
-    ifstream file(filename, ios::binary);
-    if (!file.is_open()) {
-        cerr << "Erro: não foi possível abrir " << filename << endl;
-        return false;
+static int coeff_band(int k) {
+    int band = 0;
+    while (k > 0) {
+        band++;
+        k >>= 1;
+    }
+    return band;
+}
+
+int DCTCodec::eob_context() const {
+    return 2 + coeff_band(max(m_num_coeffs - 1, 0));
+}
+
+int DCTCodec::run_context() const {
+    return eob_context() + 1;
+}
+
+int DCTCodec::num_rice_contexts() const {
+    return run_context() + 1;
+}
+
+static const char* transform_name(DCTTransform transform) {
+    switch (transform) {
+        case DCTTransform::MDCT_SINE: return "MDCT (janela seno)";
+        case DCTTransform::MDCT_KBD: return "MDCT (janela KBD)";
+        default: return "DCT";
+    }
+}
+
+static const char* coding_name(DCTCoding coding) {
+    switch (coding) {
+        case DCTCoding::RICE: return "Golomb-Rice";
+        case DCTCoding::HUFFMAN: return "Huffman";
+        default: return "raw";
     }
+}
+
+int DCTCodec::num_coded_blocks(uint64_t total_samples) const {
+    return static_cast<int>((total_samples + m_block_size - 1) / m_block_size) + (is_mdct() ? 1 : 0);
+}
+
+int DCTCodec::num_bands() const {
+    return 1 + coeff_band(max(m_num_coeffs - 1, 0));
+}
+
+//-------------------------------------------------------------------------------------------
+// Símbolos de Huffman: categoria = número de bits do valor mapeado por zigzag; o
+// valor é depois completado pelos bits abaixo do mais significativo
+//-------------------------------------------------------------------------------------------
+static int huffman_category(uint32_t m) {
+    int category = 0;
+    while (m > 0) {
+        category++;
+        m >>= 1;
+    }
+    return category;
+}
+
+int DCTCodec::coded_coeffs(const int* coeffs) const {
+    if (!m_eob) return m_num_coeffs;
     
-    // Ler RIFF header
-    file.read(header.riff, 4);
-    file.read(reinterpret_cast<char*>(&header.file_size), 4);
-    file.read(header.wave, 4);
+    int count = m_num_coeffs;
+    while (count > 0 && coeffs[count - 1] == 0) count--;
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------
+// Detetor de transientes: energia média da primeira diferença (que realça os ataques
+// face às baixas frequências) em cada sub-bloco, comparada com a média dos sub-blocos
+// anteriores, a começar pelo último sub-bloco do bloco anterior
+//-------------------------------------------------------------------------------------------
+bool DCTCodec::detect_transient(const short* samples, int actual_samples) const {
+    int M = m_block_size / DCT_SHORT_BLOCKS;
+    double previous = 0.0;      // Soma das energias dos sub-blocos anteriores
     
-    // Validar RIFF/WAVE
-    if (strncmp(header.riff, "RIFF", 4) != 0 || strncmp(header.wave, "WAVE", 4) != 0) {
-        cerr << "Erro: formato WAV inválido" << endl;
-        return false;
+    for (int s = -1; s < DCT_SHORT_BLOCKS && s * M < actual_samples; s++) {
+        int end = min((s + 1) * M, actual_samples);
+        double energy = 0.0;
+        for (int n = s * M; n < end; n++) {
+            double d = samples[n] - samples[n - 1];
+            energy += d * d;
+        }
+        energy /= end - s * M;
+        
+        if (s >= 0 && energy > DCT_TRANSIENT_RATIO * max(previous / (s + 1), DCT_TRANSIENT_FLOOR)) {
+            return true;
+        }
+        previous += energy;
+    }
+    return false;
+}
+
+//-------------------------------------------------------------------------------------------
+// Análise de um bloco: DC + DCT
+//-------------------------------------------------------------------------------------------
+double DCTCodec::analyze_block(const short* samples, int actual_samples, double* values) {
+    if (is_mdct()) {
+        vector<double> coeffs = apply_mdct(vector<short>(samples, samples + 2 * m_block_size));
+        values[0] = 0.0;
+        copy(coeffs.begin(), coeffs.begin() + m_num_coeffs, values + 1);
+        
+        double discarded = 0.0;
+        for (int k = m_num_coeffs; k < m_block_size; k++) {
+            discarded += coeffs[k] * coeffs[k];
+        }
+        return discarded;
     }
     
-    // Procurar chunk "fmt "
-    char chunk_id[4];
-    int chunk_size;
-    bool found_fmt = false;
+    // Calcular e remover componente DC (média do bloco)
+    double dc_mean = 0.0;
+    for (int i = 0; i < actual_samples; i++) {
+        dc_mean += samples[i];
+    }
+    dc_mean /= actual_samples;
     
-    while (file.read(chunk_id, 4)) {
-        file.read(reinterpret_cast<char*>(&chunk_size), 4);
-        
-        if (strncmp(chunk_id, "fmt ", 4) == 0) {
-            found_fmt = true;
-            file.read(reinterpret_cast<char*>(&header.audio_format), 2);
-            file.read(reinterpret_cast<char*>(&header.num_channels), 2);
-            file.read(reinterpret_cast<char*>(&header.sample_rate), 4);
-            file.read(reinterpret_cast<char*>(&header.byte_rate), 4);
-            file.read(reinterpret_cast<char*>(&header.block_align), 2);
-            file.read(reinterpret_cast<char*>(&header.bits_per_sample), 2);
-            header.fmt_size = chunk_size;
-            
-            // Pular bytes extras do fmt se houver
-            if (chunk_size > 16) {
-                file.seekg(chunk_size - 16, ios::cur);
+    // Remover DC para melhorar a eficiência da DCT (padding com zeros se necessário)
+    vector<short> zero_mean_block(m_block_size, 0);
+    for (int i = 0; i < actual_samples; i++) {
+        zero_mean_block[i] = samples[i] - static_cast<short>(round(dc_mean));
+    }
+    
+    values[0] = round(dc_mean);
+    
+    // Aplicar DCT (ou as DCTs curtas num transiente) no sinal com média zero e
+    // guardar os primeiros k coeficientes
+    bool short_block = m_block_switching && detect_transient(samples, actual_samples);
+    if (m_block_switching) {
+        values[1 + m_num_coeffs] = short_block ? 1.0 : 0.0;
+    }
+    vector<double> dct_coeffs = short_block ? apply_short_dct(zero_mean_block) : apply_dct(zero_mean_block);
+    copy(dct_coeffs.begin(), dct_coeffs.begin() + m_num_coeffs, values + 1);
+    
+    double discarded = 0.0;
+    for (int k = m_num_coeffs; k < m_block_size; k++) {
+        discarded += dct_coeffs[k] * dct_coeffs[k];
+    }
+    return discarded;
+}
+
+void DCTCodec::quantize_blocks(const double* values, int num_blocks, double step, int* quantized) const {
+    int values_per_block = this->values_per_block();
+    for (int b = 0; b < num_blocks; b++) {
+        const double* v = values + static_cast<size_t>(b) * values_per_block;
+        int* q = quantized + static_cast<size_t>(b) * values_per_block;
+        q[0] = static_cast<int>(v[0]);
+        for (int k = 0; k < m_num_coeffs; k++) {
+            q[1 + k] = quantize(v[1 + k], step * m_coeff_scale[k]);
+        }
+        if (m_block_switching) {
+            q[1 + m_num_coeffs] = static_cast<int>(v[1 + m_num_coeffs]);
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// Controlo de débito / SNR: passo de quantização de um segmento
+//-------------------------------------------------------------------------------------------
+int DCTCodec::choose_step(const double* values, size_t stride, int num_blocks, double budget_bits,
+                          double signal_energy, double noise_floor) {
+    int values_per_block = this->values_per_block();
+    vector<int> quantized(static_cast<size_t>(num_blocks) * values_per_block);
+    
+    // Bits do segmento (todos os canais) com o passo dado
+    auto bits = [&](int step) {
+        BitCounter counter;
+        for (int c = 0; c < m_num_channels; c++) {
+            counter.write_n_bits(step, DCT_STEP_BITS);
+            quantize_blocks(values + c * stride, num_blocks, static_cast<double>(step) / DCT_STEP_SCALE,
+                            quantized.data());
+            encode_segment(quantized.data(), num_blocks, counter);
+        }
+        return static_cast<double>(counter.size());
+    };
+    
+    // Ruído de quantização do segmento (Parseval: igual no domínio da DCT)
+    auto noise = [&](int step) {
+        double delta = static_cast<double>(step) / DCT_STEP_SCALE;
+        double total = noise_floor;
+        for (int c = 0; c < m_num_channels; c++) {
+            for (int b = 0; b < num_blocks; b++) {
+                const double* v = values + c * stride + static_cast<size_t>(b) * values_per_block;
+                for (int k = 1; k <= m_num_coeffs; k++) {
+                    double d = delta * m_coeff_scale[k - 1];
+                    double e = v[k] - d * round(v[k] / d);
+                    total += e * e;
+                }
             }
-            break;
-        } else {
+        }
+        return total;
+    };
+    
+    // Bits diminuem e ruído aumenta com o passo: procura-se o menor passo que cabe
+    // no orçamento (débito) ou o maior que não passa o ruído permitido (SNR); a
+    // bisseção pára mais cedo quando o passo cumpre o alvo a menos de 1%
+    bool by_rate = m_target_kbps > 0.0;
+    double limit = by_rate ? budget_bits : signal_energy / pow(10.0, m_target_snr / 10.0);
+    auto measure = [&](int step) { return by_rate ? bits(step) : noise(step); };
+    
+    int lo = DCT_STEP_SCALE;    // Q = 1
+    int hi = DCT_STEP_MAX;
+    
+    // RAW: menor passo sem coeficientes acima de DCT_RAW_MAX (o maior passo dá sempre 0)
+    if (m_coding == DCTCoding::RAW) {
+        auto fits = [&](int step) {
+            for (int c = 0; c < m_num_channels; c++) {
+                quantize_blocks(values + c * stride, num_blocks, static_cast<double>(step) / DCT_STEP_SCALE,
+                                quantized.data());
+                for (int b = 0; b < num_blocks; b++) {
+                    const int* q = quantized.data() + static_cast<size_t>(b) * values_per_block;
+                    for (int k = 1; k <= m_num_coeffs; k++) {
+                        if (abs(q[k]) > DCT_RAW_MAX) return false;
+                    }
+                }
+            }
+            return true;
+        };
+        if (!fits(lo)) {
+            int coarse = hi;
+            while (coarse - lo > 1) {
+                int mid = lo + (coarse - lo) / 2;
+                if (fits(mid)) coarse = mid;
+                else lo = mid;
+            }
+            lo = coarse;
+        }
+        // Os bits não dependem do passo: o menor passo é o de maior SNR
+        if (by_rate) return lo;
+    }
+    if (by_rate ? measure(lo) <= limit : measure(lo) > limit) return lo;
+    if (by_rate ? measure(hi) > limit : measure(hi) <= limit) return hi;
+    
+    // Invariante: lo é fino demais (débito) / cumpre (SNR) e hi o contrário
+    while (hi - lo > 1) {
+        int mid = lo + (hi - lo) / 2;
+        double value = measure(mid);
+        if (value <= limit && value >= 0.99 * limit) return mid;
+        if ((value <= limit) == by_rate) hi = mid;
+        else lo = mid;
+    }
+    return by_rate ? hi : lo;
+}
 
-            file.seekg(chunk_size, ios::cur);
+//-------------------------------------------------------------------------------------------
+// Codificação de um segmento
+//-------------------------------------------------------------------------------------------
+template <typename Writer>
+void DCTCodec::encode_segment(const int* quantized, int num_blocks, Writer& out) {
+    int values_per_block = this->values_per_block();
+    RiceContext rice(num_rice_contexts());
+    
+    // Em Huffman o código de cada segmento vem do histograma dos seus coeficientes
+    // e é escrito no início do segmento
+    vector<HuffmanCode> huffman;
+    if (m_coding == DCTCoding::HUFFMAN) {
+        vector<vector<uint64_t>> histograms(num_bands(), vector<uint64_t>(DCT_HUFFMAN_SYMBOLS, 0));
+        for (int b = 0; b < num_blocks; b++) {
+            const int* coeffs = quantized + static_cast<size_t>(b) * values_per_block + 1;
+            int count = coded_coeffs(coeffs);
+            for (int k = 0; k < count; k++) {
+                histograms[coeff_band(k)][huffman_category(zigzag_encode(coeffs[k]))]++;
+            }
+        }
+        for (const auto& histogram : histograms) {
+            huffman.push_back(HuffmanCode::from_histogram(histogram));
+            huffman.back().write_table(out);
         }
     }
     
-    if (!found_fmt) {
-        cerr << "Erro: chunk 'fmt ' não encontrado" << endl;
-        return false;
+    for (int b = 0; b < num_blocks; b++) {
+        write_block(out, quantized + static_cast<size_t>(b) * values_per_block, rice, huffman);
     }
+}
+
+//-------------------------------------------------------------------------------------------
+// Escrita dos valores quantizados de um bloco
+//-------------------------------------------------------------------------------------------
+template <typename Writer>
+void DCTCodec::write_block(Writer& out, const int* quantized, RiceContext& rice,
+                           const vector<HuffmanCode>& huffman) {
+    // Escrever um valor: Golomb-Rice no contexto dado, Huffman (só coeficientes),
+    // ou sinal (1 bit) e magnitude (15 bits), saturada em DCT_RAW_MAX
+    auto write_value = [&](int context, int value) {
+        if (m_coding == DCTCoding::HUFFMAN && context > 0) {
+            uint32_t m = zigzag_encode(value);
+            int category = huffman_category(m);
+            huffman[context - 1].encode(out, category);
+            if (category > 1) out.write_n_bits(m, category - 1);
+        } else if (m_coding != DCTCoding::RAW) {
+            rice.write(out, context, value);
+        } else {
+            out.write_bit((value < 0) ? 1 : 0);
+            out.write_n_bits(min(abs(value), DCT_RAW_MAX), 15);
+        }
+    };
     
-    if (header.num_channels != 1) {
-        cerr << "Erro: apenas suportado áudio mono (1 canal)" << endl;
-        return false;
+    // Tipo do bloco (comutação de blocos) e DC offset
+    if (m_block_switching) {
+        out.write_bit(quantized[1 + m_num_coeffs]);
     }
+    write_value(0, quantized[0]);
     
-    if (header.bits_per_sample != 16) {
-        cerr << "Erro: apenas suportado 16 bits por amostra" << endl;
-        return false;
+    const int* coeffs = quantized + 1;
+    if (!m_eob) {
+        for (int k = 0; k < m_num_coeffs; k++) {
+            write_value(1 + coeff_band(k), coeffs[k]);
+        }
+        return;
     }
     
-    // Procurar chunk "data"
-    bool found_data = false;
-    file.clear();  // Limpar possíveis flags de erro
-    file.seekg(12, ios::beg);  // Voltar ao início dos chunks (depois de RIFF/size/WAVE)
+    // EOB: só se escrevem os coeficientes até ao último não nulo, precedidos do
+    // seu número. Com entropia (Rice/Huffman) cada zero intermédio já custa ~1 bit;
+    // em raw os zeros antes de cada valor são substituídos pelo comprimento da corrida.
+    int count = coded_coeffs(coeffs);
+    rice.write_unsigned(out, eob_context(), count);
     
-    while (file.read(chunk_id, 4)) {
-        file.read(reinterpret_cast<char*>(&chunk_size), 4);
-        
-        if (strncmp(chunk_id, "data", 4) == 0) {
-            found_data = true;
-            memcpy(header.data, "data", 4);
-            header.data_size = chunk_size;
-            
-            // Ler amostras
-            int num_samples = chunk_size / 2;  // 2 bytes por amostra (16-bit)
-            samples.resize(num_samples);
-            file.read(reinterpret_cast<char*>(samples.data()), chunk_size);
-            break;
+    int run = 0;
+    for (int k = 0; k < count; k++) {
+        if (m_coding != DCTCoding::RAW) {
+            write_value(1 + coeff_band(k), coeffs[k]);
+        } else if (coeffs[k] == 0) {
+            run++;
         } else {
+            rice.write_unsigned(out, run_context(), run);
+            write_value(0, coeffs[k]);
+            run = 0;
+        }
+    }
+}
 
-            file.seekg(chunk_size, ios::cur);
+//-------------------------------------------------------------------------------------------
+// Leitura dos valores quantizados de um bloco
+//-------------------------------------------------------------------------------------------
+void DCTCodec::read_block(BitStream& bs, int* quantized, RiceContext& rice,
+                          const vector<HuffmanCode>& huffman) {
+    auto read_value = [&](int context) {
+        if (m_coding == DCTCoding::HUFFMAN && context > 0) {
+            int category = huffman[context - 1].decode(bs);
+            uint32_t m = (category > 1) ? ((1u << (category - 1)) | bs.read_n_bits(category - 1)) : category;
+            return static_cast<int>(zigzag_decode(m));
         }
+        if (m_coding != DCTCoding::RAW) {
+            return static_cast<int>(rice.read(bs, context));
+        }
+        int sign = bs.read_bit();
+        int magnitude = bs.read_n_bits(15);
+        return (sign == 1) ? -magnitude : magnitude;
+    };
+    
+    // Tipo do bloco (comutação de blocos) e DC offset
+    if (m_block_switching) {
+        quantized[1 + m_num_coeffs] = bs.read_bit();
     }
+    quantized[0] = read_value(0);
     
-    if (!found_data) {
-        cerr << "Erro: chunk 'data' não encontrado" << endl;
-        return false;
+    if (!m_eob) {
+        for (int k = 0; k < m_num_coeffs; k++) {
+            quantized[1 + k] = read_value(1 + coeff_band(k));
+        }
+        return;
     }
     
-    file.close();
-    return true;
+    // Coeficientes até ao EOB; o resto fica a zero
+    fill(quantized + 1, quantized + 1 + m_num_coeffs, 0);
+    int count = min(static_cast<int>(rice.read_unsigned(bs, eob_context())), m_num_coeffs);
+    
+    for (int k = 0; k < count; k++) {
+        if (m_coding != DCTCoding::RAW) {
+            quantized[1 + k] = read_value(1 + coeff_band(k));
+        } else {
+            k += rice.read_unsigned(bs, run_context());
+            if (k >= count) break;      // Ficheiro corrompido
+            quantized[1 + k] = read_value(0);
+        }
+    }
 }
 
 //-------------------------------------------------------------------------------------------
-// Escrita de ficheiro WAV
+// Descodificação de uma trama MDCT (antes da sobreposição)
 //-------------------------------------------------------------------------------------------
-bool write_wav_file(const string& filename, const WAVHeader& header, const vector<short>& samples) {
-    ofstream file(filename, ios::binary);
-    if (!file.is_open()) {
-        cerr << "Erro: não foi possível criar " << filename << endl;
-        return false;
+void DCTCodec::decode_frame(const int* quantized, double* out, double step) {
+    vector<double> coeffs(m_block_size, 0.0);
+    for (int k = 0; k < m_num_coeffs; k++) {
+        coeffs[k] = dequantize(quantized[1 + k], step * m_coeff_scale[k]);
     }
     
-    // Escrever cabeçalho
-    file.write(reinterpret_cast<const char*>(&header), sizeof(WAVHeader));
+    vector<double> values = apply_imdct(coeffs);
+    copy(values.begin(), values.end(), out);
+}
+
+//-------------------------------------------------------------------------------------------
+// Descodificação de um bloco
+//-------------------------------------------------------------------------------------------
+void DCTCodec::decode_block(const int* quantized, short* out, int actual_samples, double step) {
+    int dc_offset = quantized[0];
+    
+    // Dequantizar; os restantes coeficientes ficam a zero (perda de informação)
+    vector<double> coeffs(m_block_size, 0.0);
+    for (int k = 0; k < m_num_coeffs; k++) {
+        coeffs[k] = dequantize(quantized[1 + k], step * m_coeff_scale[k]);
+    }
     
-    // Escrever amostras
-    file.write(reinterpret_cast<const char*>(samples.data()), samples.size() * sizeof(short));
+    // Aplicar IDCT (as IDCTs curtas num bloco curto)
+    bool short_block = m_block_switching && quantized[1 + m_num_coeffs] != 0;
+    vector<short> block = short_block ? apply_short_idct(coeffs) : apply_idct(coeffs);
     
-    file.close();
-    return true;
+    // Restaurar componente DC
+    for (int i = 0; i < actual_samples; i++) {
+        int restored_value = block[i] + dc_offset;
+        
+        // Limitar ao range de 16-bit signed
+        if (restored_value > 32767) restored_value = 32767;
+        if (restored_value < -32768) restored_value = -32768;
+        
+        out[i] = static_cast<short>(restored_value);
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// Separação/junção dos canais (com MID/SIDE em estéreo, como no channel_recovery_demo)
+//-------------------------------------------------------------------------------------------
+void DCTCodec::split_channels(const short* interleaved, int frames, short* planar, size_t stride) const {
+    if (m_mid_side && m_num_channels == 2) {
+        for (int i = 0; i < frames; i++) {
+            int L = interleaved[2 * i];
+            int R = interleaved[2 * i + 1];
+            planar[i] = static_cast<short>((L + R) / 2);            // MID
+            planar[stride + i] = static_cast<short>((L - R) / 2);   // SIDE
+        }
+        return;
+    }
+    
+    for (int i = 0; i < frames; i++) {
+        for (int c = 0; c < m_num_channels; c++) {
+            planar[c * stride + i] = interleaved[i * m_num_channels + c];
+        }
+    }
+}
+
+void DCTCodec::join_channels(const short* planar, size_t stride, int frames, short* interleaved) const {
+    if (m_mid_side && m_num_channels == 2) {
+        for (int i = 0; i < frames; i++) {
+            int MID = planar[i];
+            int SIDE = planar[stride + i];
+            interleaved[2 * i] = static_cast<short>(clamp(MID + SIDE, -32768, 32767));       // L
+            interleaved[2 * i + 1] = static_cast<short>(clamp(MID - SIDE, -32768, 32767));   // R
+        }
+        return;
+    }
+    
+    for (int i = 0; i < frames; i++) {
+        for (int c = 0; c < m_num_channels; c++) {
+            interleaved[i * m_num_channels + c] = planar[c * stride + i];
+        }
+    }
 }
 
 //-------------------------------------------------------------------------------------------
 // ENCODER - Codifica ficheiro WAV para formato .dct
 //-------------------------------------------------------------------------------------------
 bool DCTCodec::encode(const string& input_file, const string& output_file) {
-    // Ler ficheiro WAV
-    WAVHeader header;
-    vector<short> samples;
+    // Abrir ficheiro WAV (as amostras são lidas lote a lote)
+    WAVReader reader;
+    if (!reader.open(input_file)) {
+        return false;
+    }
+    const WAVHeader& header = reader.header();
+    m_num_channels = header.num_channels;
+    bool mid_side = m_mid_side && m_num_channels == 2;
+    if (reader.num_samples() / m_num_channels > UINT32_MAX) {
+        cerr << "Erro: demasiadas amostras para o formato .dct" << endl;
+        return false;
+    }
+    uint32_t total_frames = static_cast<uint32_t>(reader.num_samples() / m_num_channels);
+    
+    ostream info(m_verbose ? cout.rdbuf() : nullptr);
+    info << "Codificando: " << input_file << endl;
+    if (reader.format() != WAVSampleFormat::PCM_16 || reader.is_rf64()) {
+        info << "  Formato: " << wav_format_name(reader.format()) << (reader.is_rf64() ? " (RF64)" : "")
+             << (reader.format() != WAVSampleFormat::PCM_16 ? ", convertido para 16 bits" : "") << endl;
+    }
+    info << "  Sample rate: " << header.sample_rate << " Hz" << endl;
+    info << "  Canais: " << m_num_channels << (mid_side ? " (MID/SIDE)" : "") << endl;
+    info << "  Amostras: " << total_frames << (m_num_channels > 1 ? " por canal" : "") << endl;
+    info << "  Tamanho do bloco: " << m_block_size << endl;
+    info << "  Coeficientes guardados: " << m_num_coeffs << endl;
+    info << "  Fator de quantização: " << m_quantization_factor << endl;
+    info << "  Transformada: " << transform_name(m_transform) << (m_block_switching ? " + comutação de blocos" : "") << endl;
+    info << "  Codificação: " << coding_name(m_coding) << (m_eob ? " + EOB" : "") << endl;
     
-    if (!read_wav_file(input_file, header, samples)) {
+    if (is_mdct() && m_block_size % 2 != 0) {
+        cerr << "Erro: a MDCT precisa de um tamanho de bloco par" << endl;
+        return false;
+    }
+    if (m_block_switching && (is_mdct() || m_block_size % DCT_SHORT_BLOCKS != 0 ||
+                              m_block_size < 2 * DCT_SHORT_BLOCKS)) {
+        cerr << "Erro: a comutação de blocos precisa da DCT e de um tamanho de bloco múltiplo de "
+             << DCT_SHORT_BLOCKS << " (mínimo " << 2 * DCT_SHORT_BLOCKS << ")" << endl;
         return false;
     }
     
-    cout << "Codificando: " << input_file << endl;
-    cout << "  Sample rate: " << header.sample_rate << " Hz" << endl;
-    cout << "  Amostras: " << samples.size() << endl;
-    cout << "  Tamanho do bloco: " << m_block_size << endl;
-    cout << "  Coeficientes guardados: " << m_num_coeffs << endl;
-    cout << "  Fator de quantização: " << m_quantization_factor << endl;
+    build_weights(header.sample_rate);
+    if (!m_weights.empty()) {
+        info << "  Matriz de quantização: " << (m_matrix == DCTMatrix::PERCEPTUAL ? "perceptual" : "ficheiro")
+             << " (pesos " << m_coeff_scale.front() << " a " << m_coeff_scale.back() << ")" << endl;
+    }
+    
+    bool rate_control = m_target_kbps > 0.0 || m_target_snr > 0.0;
+    if (m_target_kbps > 0.0) {
+        info << "  Débito alvo: " << m_target_kbps << " kbps" << endl;
+    } else if (m_target_snr > 0.0) {
+        info << "  SNR alvo: " << m_target_snr << " dB" << endl;
+    }
     
     // Abrir ficheiro de saída com BitStream
     fstream output(output_file, ios::out | ios::binary);
@@ -272,178 +1300,530 @@ bool DCTCodec::encode(const string& input_file, const string& output_file) {
     
     BitStream bs(output, STREAM_WRITE);
     
-    // Escrever cabeçalho do formato .dct
-    bs.write_n_bits(m_block_size, 16);           // Tamanho do bloco
+    // Escrever cabeçalho do formato .dct (estendido só quando há flags)
+    int flags = ((m_coding == DCTCoding::RICE) ? DCT_FLAG_RICE : 0) |
+                ((m_coding == DCTCoding::HUFFMAN) ? DCT_FLAG_HUFFMAN : 0) |
+                (m_eob ? DCT_FLAG_EOB : 0) |
+                ((m_num_channels > 1) ? DCT_FLAG_CHANNELS : 0) |
+                (mid_side ? DCT_FLAG_MID_SIDE : 0) |
+                (m_seek_index ? DCT_FLAG_SEEK_INDEX : 0) |
+                (rate_control ? DCT_FLAG_SEGMENT_STEP : 0) |
+                (!m_weights.empty() ? DCT_FLAG_QUANT_MATRIX : 0) |
+                (is_mdct() ? DCT_FLAG_MDCT : 0) |
+                ((m_transform == DCTTransform::MDCT_KBD) ? DCT_FLAG_KBD : 0) |
+                (m_block_switching ? DCT_FLAG_BLOCK_SWITCH : 0);
+    m_segment_blocks = DCT_SEGMENT_BLOCKS;
+    
+    if (flags != 0 && m_block_size >= DCT_FORMAT_EXTENDED) {
+        cerr << "Erro: tamanho do bloco demasiado grande para o formato estendido" << endl;
+        return false;
+    }
+    
+    // Posição (em bytes) do campo com a posição do índice, corrigido no fim
+    off_t index_field = 0;
+    
+    if (flags != 0) {
+        bs.write_n_bits(m_block_size | DCT_FORMAT_EXTENDED, 16);
+        bs.write_n_bits(flags, 16);              // Flags do formato
+        bs.write_n_bits(m_segment_blocks, 16);   // Blocos por segmento
+        if (flags & DCT_FLAG_CHANNELS) {
+            bs.write_n_bits(m_num_channels, 16); // Número de canais
+        }
+        if (flags & DCT_FLAG_SEEK_INDEX) {
+            index_field = bs.tell();
+            bs.write_n_bits(0, 64);              // Posição do índice (provisória)
+        }
+    } else {
+        bs.write_n_bits(m_block_size, 16);       // Tamanho do bloco
+    }
     bs.write_n_bits(m_num_coeffs, 16);           // Número de coeficientes
     bs.write_n_bits(m_quantization_factor, 16);  // Fator de quantização
     bs.write_n_bits(header.sample_rate, 32);     // Sample rate
-    bs.write_n_bits(samples.size(), 32);         // Número total de amostras
+    bs.write_n_bits(total_frames, 32);           // Número de amostras (por canal)
+    for (int weight : m_weights) {
+        bs.write_n_bits(weight, 8);              // Pesos da matriz de quantização
+    }
     
-    // Processar blocos
-    int num_blocks = (samples.size() + m_block_size - 1) / m_block_size;
-    int total_bits = 0;
+    // O cabeçalho tem sempre um número inteiro de bytes
+    uint64_t stream_bits = 8 * static_cast<uint64_t>(bs.tell());
+    vector<uint64_t> segment_offsets;
     
-    for (int b = 0; b < num_blocks; b++) {
-        // Extrair bloco (padding com zeros se necessário)
-        vector<short> block(m_block_size, 0);
-        int start = b * m_block_size;
-        int end = min(start + m_block_size, static_cast<int>(samples.size()));
+    // Processar blocos em lotes de batch_blocks: lê-se um lote do WAV, separam-se
+    // os canais e calcula-se a DCT de cada bloco; com controlo de débito/SNR escolhe-se
+    // depois o passo de cada segmento sobre esses valores. Por fim cada tarefa quantiza
+    // e codifica um segmento (m_segment_blocks blocos) de um canal para o seu buffer e
+    // os buffers são escritos no ficheiro por segmento e, dentro do segmento, por
+    // canal. A memória usada depende só do tamanho do lote, não do tamanho do ficheiro.
+    //
+    // Na MDCT a trama b do lote cobre os blocos b-1 e b: cada canal guarda antes do
+    // lote o último bloco do lote anterior (history) e o lote onde o ficheiro acaba
+    // tem mais uma trama, com o último bloco e zeros. Com comutação de blocos o
+    // history dá ao detetor de transientes o fim do bloco anterior.
+    prepare_transform();
+    
+    int batch_blocks = m_segment_blocks * 4 * m_num_threads;
+    int values_per_block = this->values_per_block();
+    size_t batch_frames = static_cast<size_t>(batch_blocks) * m_block_size;
+    int history = (is_mdct() || m_block_switching) ? m_block_size : 0;
+    size_t channel_stride = batch_frames + 2 * history;
+    vector<short> interleaved(batch_frames * m_num_channels);
+    vector<short> samples(channel_stride * m_num_channels, 0);  // Um canal a seguir ao outro
+    vector<double> values(static_cast<size_t>(batch_blocks + 1) * values_per_block * m_num_channels);
+    vector<double> signal_energy, noise_floor;              // Por tarefa (controlo de SNR)
+    vector<int> short_blocks;                               // Blocos curtos por tarefa
+    vector<int> steps;                                      // Passo de cada segmento
+    vector<uint64_t> channel_bits(m_num_channels, 0);
+    vector<BitBuffer> outputs;
+    double carry_bits = 0.0;    // Orçamento que sobrou (ou faltou) nos lotes anteriores
+    int min_step = DCT_STEP_MAX, max_step = 0;
+    uint64_t total_short_blocks = 0, total_blocks = 0;
+    uint32_t frames_read = 0;
+    bool tail_done = !is_mdct();
+    
+    while (true) {
+        int total = static_cast<int>(reader.read(interleaved.data(), interleaved.size()) / m_num_channels);
+        if (total == 0 && tail_done) break;
+        frames_read += total;
+        bool tail = !tail_done && frames_read >= total_frames;     // Trama final da MDCT
+        tail_done = tail_done || tail;
         
-        for (int i = start; i < end; i++) {
-            block[i - start] = samples[i];
+        split_channels(interleaved.data(), total, samples.data() + history, channel_stride);
+        for (int c = 0; c < m_num_channels && history > 0; c++) {
+            fill(samples.begin() + c * channel_stride + history + total, samples.begin() + (c + 1) * channel_stride, 0);
         }
         
-        // Calcular e remover componente DC (média do bloco)
-        double dc_mean = 0.0;
-        int actual_samples = end - start;
-        for (int i = 0; i < actual_samples; i++) {
-            dc_mean += block[i];
-        }
-        dc_mean /= actual_samples;
+        int count = (total + m_block_size - 1) / m_block_size + (tail ? 1 : 0);
+        int num_segments = (count + m_segment_blocks - 1) / m_segment_blocks;
+        int num_tasks = num_segments * m_num_channels;
+        size_t channel_values = static_cast<size_t>(count) * values_per_block;   // Valores por canal
+        outputs.assign(num_tasks, BitBuffer());
+        signal_energy.assign(num_tasks, 0.0);
+        noise_floor.assign(num_tasks, 0.0);
+        short_blocks.assign(num_tasks, 0);
+        
+        // DCT de todos os blocos do lote, guardada para não repetir a transformada
+        // em cada passo experimentado
+        run_parallel(num_tasks, [&](size_t t) {
+            int c = static_cast<int>(t % m_num_channels);
+            int b0 = static_cast<int>(t / m_num_channels) * m_segment_blocks;
+            int b1 = min(b0 + m_segment_blocks, count);
+            const short* channel = samples.data() + c * channel_stride;
+            
+            for (int b = b0; b < b1; b++) {
+                int start = b * m_block_size;
+                int end = min(start + m_block_size, total);
+                double* v = values.data() + c * channel_values + static_cast<size_t>(b) * values_per_block;
+                noise_floor[t] += analyze_block(channel + (is_mdct() ? start : history + start), end - start, v);
+                if (m_block_switching && v[1 + m_num_coeffs] != 0.0) short_blocks[t]++;
+                if (m_target_snr > 0.0) {
+                    const short* block = channel + history;
+                    for (int i = start; i < end; i++) signal_energy[t] += static_cast<double>(block[i]) * block[i];
+                }
+            }
+        });
         
-        // Remover DC para melhorar a eficiência da DCT
-        vector<short> zero_mean_block(m_block_size, 0);
-        for (int i = 0; i < actual_samples; i++) {
-            zero_mean_block[i] = block[i] - static_cast<short>(round(dc_mean));
+        // Passo de cada segmento (comum aos canais): Q fixo ou controlo de débito/SNR,
+        // com o orçamento de cada segmento proporcional às suas amostras
+        steps.assign(num_segments, m_quantization_factor * DCT_STEP_SCALE);
+        vector<double> budgets(num_segments, 0.0);
+        if (rate_control) {
+            for (int seg = 0; seg < num_segments; seg++) {
+                int frames = max(0, min((seg + 1) * m_segment_blocks * m_block_size, total) - seg * m_segment_blocks * m_block_size);
+                budgets[seg] = m_target_kbps * 1000.0 * frames / header.sample_rate;
+            }
+            run_parallel(num_segments, [&](size_t seg) {
+                double signal = 0.0, floor = 0.0;
+                for (int c = 0; c < m_num_channels; c++) {
+                    signal += signal_energy[seg * m_num_channels + c];
+                    floor += noise_floor[seg * m_num_channels + c];
+                }
+                int b0 = static_cast<int>(seg) * m_segment_blocks;
+                int b1 = min(b0 + m_segment_blocks, count);
+                double budget = max(1.0, budgets[seg] + carry_bits / num_segments);
+                steps[seg] = choose_step(values.data() + static_cast<size_t>(b0) * values_per_block, channel_values,
+                                         b1 - b0, budget, signal, floor);
+            });
         }
         
-        // Guardar DC offset (16 bits com sinal)
-        int dc_offset = static_cast<int>(round(dc_mean));
-        int dc_sign = (dc_offset < 0) ? 1 : 0;
-        int dc_magnitude = abs(dc_offset);
-        bs.write_bit(dc_sign);
-        bs.write_n_bits(dc_magnitude, 15);
-        total_bits += 16;
+        run_parallel(num_tasks, [&](size_t t) {
+            int seg = static_cast<int>(t / m_num_channels);
+            int b0 = seg * m_segment_blocks;
+            int b1 = min(b0 + m_segment_blocks, count);
+            const double* v = values.data() + (t % m_num_channels) * channel_values + static_cast<size_t>(b0) * values_per_block;
+            
+            vector<int> quantized(static_cast<size_t>(b1 - b0) * values_per_block);
+            quantize_blocks(v, b1 - b0, static_cast<double>(steps[seg]) / DCT_STEP_SCALE, quantized.data());
+            if (rate_control) {
+                outputs[t].write_n_bits(steps[seg], DCT_STEP_BITS);
+            }
+            encode_segment(quantized.data(), b1 - b0, outputs[t]);
+        });
         
-        // Aplicar DCT no sinal com média zero
-        vector<double> dct_coeffs = apply_dct(zero_mean_block);
+        for (int t = 0; t < num_tasks; t++) {
+            if (t % m_num_channels == 0) {
+                segment_offsets.push_back(stream_bits);
+                carry_bits += budgets[t / m_num_channels];
+                min_step = min(min_step, steps[t / m_num_channels]);
+                max_step = max(max_step, steps[t / m_num_channels]);
+            }
+            outputs[t].append_to(bs);
+            total_short_blocks += short_blocks[t];
+            channel_bits[t % m_num_channels] += outputs[t].size();
+            stream_bits += outputs[t].size();
+            carry_bits -= outputs[t].size();
+        }
         
-        // Quantizar e escrever os primeiros k coeficientes
-        for (int k = 0; k < m_num_coeffs; k++) {
-            int quantized = quantize(dct_coeffs[k]);
-            
-            // Escrever sinal (1 bit) e magnitude (15 bits)
-            // Isto permite valores de -32768 a 32767
-            int sign = (quantized < 0) ? 1 : 0;
-            int magnitude = abs(quantized);
-            
-            bs.write_bit(sign);
-            bs.write_n_bits(magnitude, 15);
-            total_bits += 16;
+        total_blocks += static_cast<uint64_t>(count) * m_num_channels;
+        
+        // Último bloco do lote, que é a primeira metade da próxima trama (MDCT) ou
+        // o bloco anterior ao primeiro do lote seguinte (detetor de transientes)
+        for (int c = 0; c < m_num_channels && history > 0 && total >= history; c++) {
+            short* channel = samples.data() + c * channel_stride;
+            copy(channel + total, channel + total + history, channel);
+        }
+    }
+    
+    // Índice de segmentos, alinhado ao byte
+    uint64_t index_offset = 0;
+    if (m_seek_index) {
+        int padding = static_cast<int>((8 - stream_bits % 8) % 8);
+        bs.write_n_bits(0, padding);
+        index_offset = (stream_bits + padding) / 8;
+        for (uint64_t offset : segment_offsets) {
+            bs.write_n_bits(offset, 64);
         }
     }
     
     bs.close();
     output.close();
     
-    cout << "  Bits escritos: " << total_bits << endl;
-    cout << "Ficheiro codificado: " << output_file << endl;
+    // Corrigir a posição do índice no cabeçalho
+    if (m_seek_index) {
+        fstream patch(output_file, ios::in | ios::out | ios::binary);
+        char bytes[8];
+        for (int i = 0; i < 8; i++) {
+            bytes[i] = static_cast<char>(index_offset >> (8 * (7 - i)));
+        }
+        patch.seekp(index_field);
+        patch.write(bytes, 8);
+        if (!patch) {
+            cerr << "Erro: falha ao escrever o índice em " << output_file << endl;
+            return false;
+        }
+    }
+    
+    uint64_t total_bits = 0;
+    for (uint64_t bits : channel_bits) total_bits += bits;
+    info << "  Bits escritos: " << total_bits << endl;
+    if (m_num_channels > 1) {
+        for (int c = 0; c < m_num_channels; c++) {
+            info << "    Canal " << c << (mid_side ? (c == 0 ? " (MID)" : " (SIDE)") : "")
+                 << ": " << channel_bits[c] << endl;
+        }
+    }
+    if (rate_control && max_step > 0) {
+        info << "  Débito: " << total_bits * header.sample_rate / max(total_frames, 1u) / 1000.0 << " kbps" << endl;
+        info << "  Passo por segmento: " << static_cast<double>(min_step) / DCT_STEP_SCALE << " a "
+             << static_cast<double>(max_step) / DCT_STEP_SCALE << endl;
+        
+        // Com o passo máximo sobram só o DC e um custo mínimo por coeficiente (sem EOB)
+        if (m_target_kbps > 0.0 && max_step == DCT_STEP_MAX) {
+            cerr << "Aviso: débito alvo abaixo do mínimo destes parâmetros; há segmentos sem "
+                 << "coeficientes (use -e ou menos coeficientes)" << endl;
+        }
+    }
+    if (m_block_switching) {
+        info << "  Blocos curtos: " << total_short_blocks << " de " << total_blocks << endl;
+    }
+    if (m_seek_index) {
+        info << "  Índice: " << segment_offsets.size() << " segmentos ("
+             << 8 * segment_offsets.size() << " bytes)" << endl;
+    }
+    info << "Ficheiro codificado: " << output_file << endl;
     
     return true;
 }
 
 //-------------------------------------------------------------------------------------------
-// DECODER - Descodifica ficheiro .dct para WAV
+// Cabeçalho .dct (original ou estendido)
 //-------------------------------------------------------------------------------------------
-bool DCTCodec::decode(const string& input_file, const string& output_file) {
-    // Abrir ficheiro de entrada com BitStream
-    fstream input(input_file, ios::in | ios::binary);
-    if (!input.is_open()) {
-        cerr << "Erro: não foi possível abrir " << input_file << endl;
-        return false;
-    }
-    
-    BitStream bs(input, STREAM_READ);
-    
-    // Ler cabeçalho
+bool DCTCodec::read_header(BitStream& bs) {
     int block_size = bs.read_n_bits(16);
-    int num_coeffs = bs.read_n_bits(16);
-    int quant_factor = bs.read_n_bits(16);
-    int sample_rate = bs.read_n_bits(32);
-    int total_samples = bs.read_n_bits(32);
-    
-    cout << "Descodificando: " << input_file << endl;
-    cout << "  Sample rate: " << sample_rate << " Hz" << endl;
-    cout << "  Amostras: " << total_samples << endl;
-    cout << "  Tamanho do bloco: " << block_size << endl;
-    cout << "  Coeficientes: " << num_coeffs << endl;
-    cout << "  Fator de quantização: " << quant_factor << endl;
+    int flags = 0;
+    int segment_blocks = DCT_SEGMENT_BLOCKS;
+    int num_channels = 1;
+    uint64_t index_offset = 0;
+    
+    if (block_size & DCT_FORMAT_EXTENDED) {
+        block_size &= ~DCT_FORMAT_EXTENDED;
+        flags = bs.read_n_bits(16);
+        segment_blocks = bs.read_n_bits(16);
+        if (flags & DCT_FLAG_CHANNELS) {
+            num_channels = bs.read_n_bits(16);
+        }
+        if (flags & DCT_FLAG_SEEK_INDEX) {
+            index_offset = bs.read_n_bits(64);
+        }
+        
+        if ((flags & ~DCT_KNOWN_FLAGS) != 0 || segment_blocks <= 0 || num_channels <= 0 ||
+            ((flags & DCT_FLAG_RICE) && (flags & DCT_FLAG_HUFFMAN)) ||
+            ((flags & DCT_FLAG_MID_SIDE) && num_channels != 2) ||
+            ((flags & DCT_FLAG_KBD) && !(flags & DCT_FLAG_MDCT)) ||
+            ((flags & DCT_FLAG_MDCT) && block_size % 2 != 0) ||
+            ((flags & DCT_FLAG_BLOCK_SWITCH) && ((flags & DCT_FLAG_MDCT) || block_size % DCT_SHORT_BLOCKS != 0 ||
+                                                 block_size < 2 * DCT_SHORT_BLOCKS))) {
+            cerr << "Erro: versão do formato .dct não suportada" << endl;
+            return false;
+        }
+    }
     
     // Atualizar parâmetros do codec
     m_block_size = block_size;
-    m_num_coeffs = num_coeffs;
-    m_quantization_factor = quant_factor;
+    m_num_coeffs = bs.read_n_bits(16);
+    m_quantization_factor = bs.read_n_bits(16);
+    m_sample_rate = bs.read_n_bits(32);
+    m_total_samples = bs.read_n_bits(32);
+    m_coding = (flags & DCT_FLAG_RICE) ? DCTCoding::RICE :
+               (flags & DCT_FLAG_HUFFMAN) ? DCTCoding::HUFFMAN : DCTCoding::RAW;
+    m_eob = (flags & DCT_FLAG_EOB) != 0;
+    m_segment_blocks = segment_blocks;
+    m_num_channels = num_channels;
+    m_mid_side = (flags & DCT_FLAG_MID_SIDE) != 0;
+    m_seek_index = (flags & DCT_FLAG_SEEK_INDEX) != 0;
+    m_segment_step = (flags & DCT_FLAG_SEGMENT_STEP) != 0;
+    m_transform = !(flags & DCT_FLAG_MDCT) ? DCTTransform::DCT :
+                  (flags & DCT_FLAG_KBD) ? DCTTransform::MDCT_KBD : DCTTransform::MDCT_SINE;
+    m_block_switching = (flags & DCT_FLAG_BLOCK_SWITCH) != 0;
+    m_index_offset = index_offset;
     
-    // Descodificar blocos
-    vector<short> decoded_samples;
-    int num_blocks = (total_samples + m_block_size - 1) / m_block_size;
+    if (m_block_size <= 0) {
+        cerr << "Erro: cabeçalho .dct inválido" << endl;
+        return false;
+    }
     
-    for (int b = 0; b < num_blocks; b++) {
-        // Ler DC offset (16 bits: 1 bit sinal + 15 bits magnitude)
-        int dc_sign = bs.read_bit();
-        int dc_magnitude = bs.read_n_bits(15);
-        int dc_offset = (dc_sign == 1) ? -dc_magnitude : dc_magnitude;
-        
-        // Ler coeficientes quantizados
-        vector<double> coeffs(m_block_size, 0.0);
-        
+    m_weights.clear();
+    m_coeff_scale.assign(m_num_coeffs, 1.0);
+    if (flags & DCT_FLAG_QUANT_MATRIX) {
         for (int k = 0; k < m_num_coeffs; k++) {
-            int sign = bs.read_bit();
-            int magnitude = bs.read_n_bits(15);
-            int quantized = (sign == 1) ? -magnitude : magnitude;
-            
-            // Dequantizar
-            coeffs[k] = dequantize(quantized);
+            m_weights.push_back(bs.read_n_bits(8));
+            if (m_weights[k] == 0) {
+                cerr << "Erro: cabeçalho .dct inválido" << endl;
+                return false;
+            }
+            m_coeff_scale[k] = static_cast<double>(m_weights[k]) / DCT_WEIGHT_SCALE;
         }
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+// Descodificação de um intervalo de blocos
+//-------------------------------------------------------------------------------------------
+bool DCTCodec::decode_blocks(BitStream& bs, int first_block, int end_block,
+                             const function<void(const short*, int64_t, int)>& emit) {
+    // Descodificar blocos em lotes (múltiplos de um segmento): a leitura do
+    // BitStream é sequencial, a dequantização e a IDCT de cada par (segmento, canal)
+    // correm em paralelo e o lote é entregue a emit.
+    //
+    // Na MDCT as IMDCT das tramas são calculadas em paralelo e depois sobrepostas em
+    // série em cada canal: a trama b completa o bloco b-1 com a metade final da trama
+    // anterior (guardada em overlap entre lotes). O bloco antes de first_block fica
+    // incompleto e não é entregue.
+    prepare_transform();
+    
+    int batch_blocks = m_segment_blocks * max(1, 4 * m_num_threads / m_num_channels);
+    size_t batch_frames = static_cast<size_t>(batch_blocks) * m_block_size;
+    vector<short> decoded_samples(batch_frames * m_num_channels);   // Um canal a seguir ao outro
+    vector<short> interleaved(batch_frames * m_num_channels);
+    vector<double> frame_values(is_mdct() ? 2 * batch_frames * m_num_channels : 0);
+    vector<double> overlap(is_mdct() ? static_cast<size_t>(m_block_size) * m_num_channels : 0, 0.0);
+    int values_per_block = this->values_per_block();
+    vector<int> quantized;
+    vector<double> steps;       // Passo de cada par (segmento, canal) do lote
+    RiceContext rice(num_rice_contexts());
+    vector<HuffmanCode> huffman(num_bands());
+    
+    for (int first = first_block; first < end_block; first += batch_blocks) {
+        int count = min(batch_blocks, end_block - first);
+        int num_segments = (count + m_segment_blocks - 1) / m_segment_blocks;
+        quantized.resize(static_cast<size_t>(count) * values_per_block * m_num_channels);
+        steps.assign(static_cast<size_t>(num_segments) * m_num_channels, m_quantization_factor);
         
-        // Os restantes coeficientes ficam a zero (perda de informação)
+        // Valores do bloco b do canal c em quantized[(c * count + b) * values_per_block]
+        for (int s0 = 0; s0 < count; s0 += m_segment_blocks) {
+            int s1 = min(s0 + m_segment_blocks, count);
+            for (int c = 0; c < m_num_channels; c++) {
+                if (m_segment_step) {
+                    steps[(s0 / m_segment_blocks) * m_num_channels + c] =
+                        static_cast<double>(bs.read_n_bits(DCT_STEP_BITS)) / DCT_STEP_SCALE;
+                }
+                
+                // Os modelos adaptativos recomeçam em cada segmento, que em Huffman
+                // começa pelo seu código
+                rice.reset();
+                for (size_t band = 0; m_coding == DCTCoding::HUFFMAN && band < huffman.size(); band++) {
+                    huffman[band] = HuffmanCode::read_table(bs);
+                    if (!huffman[band].is_valid() || huffman[band].num_symbols() != DCT_HUFFMAN_SYMBOLS) {
+                        cerr << "Erro: tabela de Huffman inválida" << endl;
+                        return false;
+                    }
+                }
+                for (int b = s0; b < s1; b++) {
+                    read_block(bs, quantized.data() + (static_cast<size_t>(c) * count + b) * values_per_block,
+                               rice, huffman);
+                }
+            }
+        }
         
-        // Aplicar IDCT
-        vector<short> block = apply_idct(coeffs);
+        // Na MDCT o lote entrega os blocos first-1 .. first+count-2
+        int skip = (is_mdct() && first == first_block) ? 1 : 0;
+        int64_t batch_start = static_cast<int64_t>(first - (is_mdct() ? 1 : 0) + skip) * m_block_size;
+        int batch_samples = static_cast<int>(max<int64_t>(0, min<int64_t>(static_cast<int64_t>(count - skip) * m_block_size,
+                                                                          m_total_samples - batch_start)));
         
-        // Restaurar componente DC
-        for (int i = 0; i < m_block_size; i++) {
-            int restored_value = block[i] + dc_offset;
-            
-            // Limitar ao range de 16-bit signed
-            if (restored_value > 32767) restored_value = 32767;
-            if (restored_value < -32768) restored_value = -32768;
-            
-            block[i] = static_cast<short>(restored_value);
-        }
+        run_parallel(static_cast<size_t>(num_segments) * m_num_channels, [&](size_t t) {
+            int c = static_cast<int>(t % m_num_channels);
+            int b0 = static_cast<int>(t / m_num_channels) * m_segment_blocks;
+            int b1 = min(b0 + m_segment_blocks, count);
+            short* channel = decoded_samples.data() + c * batch_frames;
+            for (int b = b0; b < b1; b++) {
+                const int* values = quantized.data() + (static_cast<size_t>(c) * count + b) * values_per_block;
+                if (is_mdct()) {
+                    decode_frame(values, frame_values.data() + (c * batch_frames + static_cast<size_t>(b) * m_block_size) * 2,
+                                 steps[t]);
+                    continue;
+                }
+                int start = b * m_block_size;
+                int end = min(start + m_block_size, batch_samples);
+                decode_block(values, channel + start, end - start, steps[t]);
+            }
+        });
         
-        // Adicionar ao vetor de saída
-        for (int i = 0; i < m_block_size && decoded_samples.size() < static_cast<size_t>(total_samples); i++) {
-            decoded_samples.push_back(block[i]);
+        if (is_mdct()) {
+            run_parallel(m_num_channels, [&](size_t c) {
+                short* channel = decoded_samples.data() + c * batch_frames;
+                double* tail = overlap.data() + c * m_block_size;
+                for (int b = 0; b < count; b++) {
+                    const double* frame = frame_values.data() + (c * batch_frames + static_cast<size_t>(b) * m_block_size) * 2;
+                    for (int n = 0; n < m_block_size; n++) {
+                        double value = round(tail[n] + frame[n]);
+                        channel[b * m_block_size + n] = static_cast<short>(clamp(value, -32768.0, 32767.0));
+                    }
+                    copy(frame + m_block_size, frame + 2 * m_block_size, tail);
+                }
+            });
         }
+        
+        join_channels(decoded_samples.data() + skip * m_block_size, batch_frames, batch_samples, interleaved.data());
+        emit(interleaved.data(), batch_start, batch_samples);
+    }
+    
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+// DECODER - Descodifica ficheiro .dct para WAV
+//-------------------------------------------------------------------------------------------
+bool DCTCodec::decode(const string& input_file, const string& output_file) {
+    // Abrir ficheiro de entrada com BitStream (mapeado em memória quando possível)
+    BitStream bs(input_file);
+    if (!bs.is_open()) {
+        cerr << "Erro: não foi possível abrir " << input_file << endl;
+        return false;
+    }
+    
+    if (!read_header(bs)) {
+        return false;
+    }
+    
+    ostream info(m_verbose ? cout.rdbuf() : nullptr);
+    info << "Descodificando: " << input_file << endl;
+    info << "  Sample rate: " << m_sample_rate << " Hz" << endl;
+    info << "  Canais: " << m_num_channels << (m_mid_side ? " (MID/SIDE)" : "") << endl;
+    info << "  Amostras: " << m_total_samples << (m_num_channels > 1 ? " por canal" : "") << endl;
+    info << "  Tamanho do bloco: " << m_block_size << endl;
+    info << "  Coeficientes: " << m_num_coeffs << endl;
+    info << "  Fator de quantização: " << m_quantization_factor
+         << (m_segment_step ? " (nominal; passo por segmento)" : "") << endl;
+    if (!m_weights.empty()) {
+        info << "  Matriz de quantização: pesos " << m_coeff_scale.front() << " a " << m_coeff_scale.back() << endl;
+    }
+    info << "  Transformada: " << transform_name(m_transform) << (m_block_switching ? " + comutação de blocos" : "") << endl;
+    info << "  Codificação: " << coding_name(m_coding) << (m_eob ? " + EOB" : "") << endl;
+    
+    WAVWriter writer;
+    if (!writer.open(output_file, m_sample_rate, m_num_channels)) {
+        return false;
     }
     
+    int num_blocks = num_coded_blocks(m_total_samples);
+    bool ok = decode_blocks(bs, 0, num_blocks, [&](const short* samples, int64_t, int frames) {
+        writer.write(samples, static_cast<size_t>(frames) * m_num_channels);
+    });
+    
     bs.close();
-    input.close();
-    
-    // Criar cabeçalho WAV
-    WAVHeader header;
-    memcpy(header.riff, "RIFF", 4);
-    memcpy(header.wave, "WAVE", 4);
-    memcpy(header.fmt, "fmt ", 4);
-    memcpy(header.data, "data", 4);
-    
-    header.fmt_size = 16;
-    header.audio_format = 1;  // PCM
-    header.num_channels = 1;  // Mono
-    header.sample_rate = sample_rate;
-    header.bits_per_sample = 16;
-    header.byte_rate = sample_rate * header.num_channels * header.bits_per_sample / 8;
-    header.block_align = header.num_channels * header.bits_per_sample / 8;
-    header.data_size = decoded_samples.size() * sizeof(short);
-    header.file_size = 36 + header.data_size;
-    
-    // Escrever ficheiro WAV
-    if (!write_wav_file(output_file, header, decoded_samples)) {
+    
+    // Corrigir os tamanhos no cabeçalho WAV
+    if (!writer.close()) {
+        cerr << "Erro: falha ao escrever " << output_file << endl;
+        return false;
+    }
+    if (!ok) {
         return false;
     }
     
-    cout << "Ficheiro descodificado: " << output_file << endl;
+    info << "Ficheiro descodificado: " << output_file << endl;
     
     return true;
 }
+
+//-------------------------------------------------------------------------------------------
+// Descodificação de um troço (acesso aleatório pelo índice de segmentos)
+//-------------------------------------------------------------------------------------------
+bool DCTCodec::decode_range(const string& input_file, uint32_t start_sample, uint32_t num_samples,
+                            vector<short>& samples) {
+    samples.clear();
+    
+    BitStream bs(input_file);
+    if (!bs.is_open()) {
+        cerr << "Erro: não foi possível abrir " << input_file << endl;
+        return false;
+    }
+    
+    if (!read_header(bs)) {
+        return false;
+    }
+    
+    uint32_t end_sample = static_cast<uint32_t>(min<uint64_t>(static_cast<uint64_t>(start_sample) + num_samples,
+                                                              m_total_samples));
+    if (start_sample >= end_sample) {
+        return true;
+    }
+    
+    // Lêem-se segmentos inteiros (com vários canais o segmento de um canal só começa
+    // depois do segmento completo do canal anterior), desde o início do segmento do
+    // troço se houver índice (na MDCT o último bloco do troço precisa da trama seguinte)
+    int num_blocks = num_coded_blocks(m_total_samples);
+    int end_block = num_coded_blocks(end_sample);
+    end_block = min(num_blocks, (end_block + m_segment_blocks - 1) / m_segment_blocks * m_segment_blocks);
+    int first_block = 0;
+    if (m_index_offset != 0) {
+        int segment = static_cast<int>(start_sample / m_block_size) / m_segment_blocks;
+        bs.seek(8 * m_index_offset + 64 * static_cast<uint64_t>(segment));
+        bs.seek(bs.read_n_bits(64));
+        first_block = segment * m_segment_blocks;
+    }
+    
+    samples.assign(static_cast<size_t>(end_sample - start_sample) * m_num_channels, 0);
+    bool ok = decode_blocks(bs, first_block, end_block, [&](const short* batch, int64_t batch_start, int frames) {
+        // Parte do lote que cai dentro do troço
+        int64_t from = max<int64_t>(batch_start, start_sample);
+        int64_t to = min<int64_t>(batch_start + frames, end_sample);
+        if (from >= to) return;
+        copy(batch + (from - batch_start) * m_num_channels, batch + (to - batch_start) * m_num_channels,
+             samples.begin() + (from - start_sample) * m_num_channels);
+    });
+    
+    bs.close();
+    return ok;
+}
@@ -11,48 +11,437 @@
 #include <vector>
 #include <string>
 #include <cmath>
+#include <complex>
+#include <memory>
+#include <functional>
+#include <fstream>
+#include <cstdint>
+#include "wav_io.h"
+
+/**
+ * @brief Implementação usada para calcular a DCT/IDCT de cada bloco
+ *
+ * NAIVE:  soma direta O(N²) com cos() em cada termo (referência)
+ * MATRIX: produtos internos sobre a tabela de cossenos pré-calculada, O(N²)
+ *         mas só multiplicações-somas; aceita qualquer tamanho de bloco
+ * FFT:    algoritmo de Makhoul sobre uma FFT complexa de N pontos, O(N log N);
+ *         só para blocos potência de 2
+ * AUTO:   FFT para potências de 2, MATRIX para os restantes tamanhos
+ *          (o dct_bench mostra a FFT à frente já a partir de 64 amostras)
+ *
+ * Quando a implementação pedida não suporta o tamanho de bloco usa-se MATRIX
+ * (até DCT_MATRIX_MAX_SIZE) ou NAIVE.
+ */
+enum class DCTEngine {
+    NAIVE,
+    MATRIX,
+    FFT,
+    AUTO
+};
+
+const int DCT_MATRIX_MAX_SIZE = 2048;   // Maior bloco com tabela N×N (32 MB)
+
+/**
+ * @brief Transformada dos blocos
+ *
+ * DCT:       DCT-II de cada bloco, com o DC (média) separado; os blocos são
+ *            independentes (formato original)
+ * MDCT_SINE: MDCT com sobreposição de 50% e janela seno: a trama j cobre os blocos
+ *            j-1 e j (2N amostras) e dá N coeficientes; a soma das IMDCT de tramas
+ *            vizinhas cancela o aliasing (TDAC) e elimina as descontinuidades nas
+ *            fronteiras dos blocos
+ * MDCT_KBD:  MDCT com janela Kaiser-Bessel-derived (alfa = DCT_KBD_ALPHA), com
+ *            lóbulos laterais mais baixos que a seno
+ */
+enum class DCTTransform {
+    DCT,
+    MDCT_SINE,
+    MDCT_KBD
+};
+
+const double DCT_KBD_ALPHA = 4.0;
+
+struct DCTBasis;    // Tabela de cossenos de um tamanho de bloco (cache partilhada)
+struct FFTPlan;     // Bit-reversal e twiddles da FFT de um tamanho de bloco
+struct MDCTPlan;    // Janela, twiddles e FFT de N/2 pontos da MDCT de um tamanho de bloco
+
+class BitBuffer;
+class BitStream;
+class ThreadPool;
+class RiceContext;
+class HuffmanCode;
+
+/**
+ * @brief Codificação dos valores quantizados (DC e coeficientes) no ficheiro
+ *
+ * RAW:  1 bit de sinal + 15 bits de magnitude por valor (formato original)
+ * RICE: Golomb-Rice adaptativo com um contexto para o DC e um por banda de
+ *       oitava dos coeficientes (k = 0, 1, 2-3, 4-7, ...)
+ * HUFFMAN: códigos de Huffman canónicos por segmento e por banda de oitava para a
+ *       categoria de cada coeficiente, seguida dos seus bits (como no JPEG); as
+ *       tabelas vão no início do segmento e o DC continua em Golomb-Rice
+ */
+enum class DCTCoding {
+    RAW,
+    RICE,
+    HUFFMAN
+};
+
+// Maior magnitude representável em RAW (15 bits); valores maiores são saturados
+const int DCT_RAW_MAX = (1 << 15) - 1;
+
+/**
+ * @brief Matriz de quantização: peso do passo de cada coeficiente
+ *
+ * FLAT:       o mesmo passo em todos os coeficientes (formato original)
+ * PERCEPTUAL: passo crescente acima de ~3.3 kHz, seguindo metade da subida do
+ *             limiar absoluto de audição (Terhardt) à taxa de amostragem do ficheiro
+ * CUSTOM:     pesos lidos de um ficheiro (load_quant_matrix)
+ */
+enum class DCTMatrix {
+    FLAT,
+    PERCEPTUAL,
+    CUSTOM
+};
+
+// Formato .dct estendido: o primeiro campo de 16 bits é block_size | DCT_FORMAT_EXTENDED
+// e é seguido de flags (16 bits) e blocos por segmento (16 bits) antes dos campos
+// do formato original. Ficheiros RAW continuam a usar o cabeçalho original.
+const int DCT_FORMAT_EXTENDED = 0x8000;
+const int DCT_FLAG_RICE = 0x0001;
+const int DCT_FLAG_EOB = 0x0002;    // Coeficientes só até ao último não nulo (+ corridas de zeros em raw)
+const int DCT_FLAG_HUFFMAN = 0x0004;
+const int DCT_FLAG_CHANNELS = 0x0008;   // Número de canais (16 bits) a seguir aos blocos por segmento
+const int DCT_FLAG_MID_SIDE = 0x0010;   // Estéreo guardado como MID/SIDE
+const int DCT_FLAG_SEEK_INDEX = 0x0020; // Posição do índice de segmentos (64 bits) no cabeçalho
+const int DCT_FLAG_SEGMENT_STEP = 0x0040;   // Passo de quantização no início de cada segmento
+const int DCT_FLAG_QUANT_MATRIX = 0x0080;   // Pesos dos coeficientes no fim do cabeçalho
+const int DCT_FLAG_MDCT = 0x0100;           // MDCT em vez da DCT (uma trama a mais que blocos)
+const int DCT_FLAG_KBD = 0x0200;            // Janela KBD na MDCT (seno sem esta flag)
+const int DCT_FLAG_BLOCK_SWITCH = 0x0400;   // Cada bloco começa por 1 bit: longo (0) ou curto (1)
+const int DCT_KNOWN_FLAGS = DCT_FLAG_RICE | DCT_FLAG_EOB | DCT_FLAG_HUFFMAN |
+                            DCT_FLAG_CHANNELS | DCT_FLAG_MID_SIDE | DCT_FLAG_SEEK_INDEX |
+                            DCT_FLAG_SEGMENT_STEP | DCT_FLAG_QUANT_MATRIX |
+                            DCT_FLAG_MDCT | DCT_FLAG_KBD | DCT_FLAG_BLOCK_SWITCH;
+
+// Passo por segmento (DCT_FLAG_SEGMENT_STEP): DCT_STEP_BITS bits em unidades de
+// 1/DCT_STEP_SCALE, escritos antes do segmento de cada canal; o Q do cabeçalho fica
+// só como valor nominal
+const int DCT_STEP_SCALE = 16;
+const int DCT_STEP_BITS = 20;
+const int DCT_STEP_MAX = (1 << DCT_STEP_BITS) - 1;
+
+// Matriz de quantização (DCT_FLAG_QUANT_MATRIX): um peso de 8 bits por coeficiente,
+// em unidades de 1/DCT_WEIGHT_SCALE (de 1/16 a 255/16), depois do número de amostras;
+// o coeficiente k usa o passo Q (ou o do segmento) vezes o seu peso
+const int DCT_WEIGHT_SCALE = 16;
+const int DCT_WEIGHT_MAX = 255;
+
+// Comutação de blocos (DCT_FLAG_BLOCK_SWITCH, só com a DCT): um bloco curto é
+// transformado como DCT_SHORT_BLOCKS DCTs de N/DCT_SHORT_BLOCKS amostras, com os
+// coeficientes intercalados (o coeficiente j do sub-bloco s fica na posição
+// j * DCT_SHORT_BLOCKS + s, a da mesma frequência no bloco longo), pelo que as bandas,
+// o EOB e os pesos dos coeficientes valem para os dois tipos de bloco. Um bloco é curto
+// quando a energia da primeira diferença num sub-bloco passa DCT_TRANSIENT_RATIO vezes a
+// média dos sub-blocos anteriores (desde o último do bloco anterior), e pelo menos
+// DCT_TRANSIENT_RATIO vezes DCT_TRANSIENT_FLOOR (para ignorar o silêncio)
+const int DCT_SHORT_BLOCKS = 8;
+const double DCT_TRANSIENT_RATIO = 10.0;
+const double DCT_TRANSIENT_FLOOR = 100.0;
+
+// Alfabeto de Huffman dos coeficientes: categoria (número de bits) do valor mapeado
+// por zigzag, de 0 a 32
+const int DCT_HUFFMAN_SYMBOLS = 33;
+
+// Blocos por segmento: unidade de trabalho das threads e ponto onde os
+// modelos adaptativos voltam ao estado inicial. Com vários canais o ficheiro
+// tem, para cada segmento, o segmento de cada canal pela ordem dos canais.
+// Na MDCT os "blocos" do ficheiro são as tramas.
+const int DCT_SEGMENT_BLOCKS = 64;
+
+// Índice de segmentos (DCT_FLAG_SEEK_INDEX): depois do último segmento, alinhado ao
+// byte, vem a posição em bits (64 bits) do início de cada segmento; o cabeçalho
+// guarda a posição em bytes do índice a seguir aos canais. Como os modelos
+// adaptativos recomeçam em cada segmento, pode descodificar-se a partir de qualquer
+// entrada do índice.
 
 /**
  * @brief Classe para codec de áudio com perdas baseado em DCT
  * 
- * Processa áudio mono em blocos, aplicando:
+ * Processa áudio em blocos, cada canal separadamente, aplicando:
  * 1. DCT (Discrete Cosine Transform)
  * 2. Quantização dos coeficientes
  * 3. Escrita em ficheiro binário usando BitStream
+ *
+ * Em estéreo os canais podem ser guardados como MID = (L+R)/2 e SIDE = (L-R)/2
+ * (divisão inteira, como no channel_recovery_demo da Parte 1), recuperados com
+ * L = MID + SIDE e R = MID - SIDE. Com L+R ímpar a recuperação difere de 1 no
+ * último bit, muito abaixo do erro de quantização da DCT.
  */
 class DCTCodec {
 private:
     int m_block_size;           // Tamanho do bloco (ex: 256, 512, 1024)
     int m_num_coeffs;           // Número de coeficientes DCT a guardar
     int m_quantization_factor;  // Fator de quantização (Q)
+    DCTEngine m_engine;         // Implementação da transformada
+    DCTTransform m_transform;   // DCT ou MDCT
+    DCTCoding m_coding;         // Codificação dos valores quantizados
+    bool m_eob;                 // Zeros codificados por corridas + end-of-block
+    int m_segment_blocks;       // Blocos por segmento
+    int m_num_channels;         // Canais do ficheiro em codificação/descodificação
+    bool m_mid_side;            // Estéreo como MID/SIDE
+    bool m_seek_index;          // Escrever o índice de segmentos
+    bool m_verbose;             // Parâmetros e estatísticas em cout
+    bool m_segment_step;        // Passo de quantização por segmento
+    double m_target_kbps;       // Controlo de débito (0 = Q fixo)
+    double m_target_snr;        // Controlo de SNR em dB (0 = Q fixo)
+    bool m_block_switching;     // Blocos curtos nos transientes
+    DCTMatrix m_matrix;         // Matriz de quantização pedida
+    std::vector<double> m_matrix_table;     // Pesos lidos de ficheiro (CUSTOM)
+    std::vector<int> m_weights;             // Pesos do ficheiro atual (vazio = FLAT)
+    std::vector<double> m_coeff_scale;      // m_weights / DCT_WEIGHT_SCALE (1.0 em FLAT)
+    
+    // Campos do último cabeçalho lido (read_header)
+    int m_sample_rate;
+    uint32_t m_total_samples;   // Amostras por canal
+    uint64_t m_index_offset;    // Posição do índice em bytes (0 sem índice)
+    
+    // Tabelas do tamanho de bloco atual, obtidas da cache partilhada por todas
+    // as instâncias (nullptr até serem precisas)
+    const DCTBasis* m_basis;
+    const FFTPlan* m_fft_plan;
+    const MDCTPlan* m_mdct_plan;
+    const DCTBasis* m_short_basis;      // Dos blocos curtos (comutação de blocos)
+    const FFTPlan* m_short_fft_plan;
+    
+    // Threads usadas por encode/decode (sem pool quando é só uma); o pool pode ser
+    // do codec ou partilhado (set_thread_pool)
+    int m_num_threads;
+    std::unique_ptr<ThreadPool> m_own_pool;
+    ThreadPool* m_pool;
     
     /**
-     * @brief Aplica DCT (Discrete Cosine Transform) a um bloco de amostras
-     * @param samples Vetor com as amostras do bloco
-     * @return Vetor com os coeficientes DCT
+     * @brief Implementação efetivamente usada para blocos de N amostras
      */
-    std::vector<double> apply_dct(const std::vector<short>& samples);
+    DCTEngine resolve_engine(int N) const;
     
     /**
-     * @brief Aplica IDCT (Inverse DCT) aos coeficientes
-     * @param coeffs Vetor com os coeficientes DCT
-     * @return Vetor com as amostras reconstruídas
+     * @brief Obtém as tabelas do tamanho de bloco atual (e dos blocos curtos) antes
+     *        de arrancar as threads, para que estas só leiam m_basis/m_fft_plan
      */
-    std::vector<short> apply_idct(const std::vector<double>& coeffs);
+    void prepare_transform();
+    
+    /**
+     * @brief Tabela/plano da FFT para blocos de N amostras: os do bloco longo ou os
+     *        do bloco curto, obtidos da cache se ainda não existirem (nullptr se a
+     *        implementação para N não os usar)
+     */
+    const DCTBasis* basis_for_size(int N);
+    const FFTPlan* fft_plan_for_size(int N);
+    
+    /**
+     * @brief MDCT em uso (MDCT_SINE ou MDCT_KBD)
+     */
+    bool is_mdct() const { return m_transform != DCTTransform::DCT; }
+    
+    /**
+     * @brief Blocos (tramas na MDCT) escritos no ficheiro para total_samples amostras
+     *        por canal: ceil(total_samples / N), mais a trama final na MDCT
+     */
+    int num_coded_blocks(uint64_t total_samples) const;
+    
+    /**
+     * @brief Executa fn(0) ... fn(count-1) no pool (ou em série sem pool)
+     */
+    void run_parallel(size_t count, const std::function<void(size_t)>& fn);
+    
+    /**
+     * @brief Lê o cabeçalho .dct e atualiza os parâmetros do codec
+     * @return false (mensagem em cerr) se o formato não for suportado
+     */
+    bool read_header(BitStream& bs);
+    
+    /**
+     * @brief Descodifica os blocos [first_block, end_block) a partir da posição atual
+     *        do BitStream, que tem de ser o início do segmento de first_block;
+     *        end_block tem de ser o fim de um segmento ou do ficheiro
+     * @param emit Recebe cada lote descodificado: amostras intercaladas, primeira
+     *        amostra (por canal) do lote no ficheiro e amostras por canal
+     * @return false se o ficheiro estiver corrompido
+     */
+    bool decode_blocks(BitStream& bs, int first_block, int end_block,
+                       const std::function<void(const short*, int64_t, int)>& emit);
+    
+    /**
+     * @brief Pesos (m_weights) da matriz pedida para a taxa de amostragem dada e
+     *        fator de escala de cada coeficiente (m_coeff_scale)
+     */
+    void build_weights(int sample_rate);
+    
+    /**
+     * @brief Contextos de Rice: DC, bandas de oitava dos coeficientes, posição do
+     *        EOB e comprimento das corridas de zeros
+     */
+    int eob_context() const;
+    int run_context() const;
+    int num_rice_contexts() const;
+    int num_bands() const;
+    
+    /**
+     * @brief Valores de cada bloco antes e depois da quantização: DC, m_num_coeffs
+     *        coeficientes e, com comutação de blocos, o tipo do bloco (1 = curto)
+     */
+    int values_per_block() const { return 1 + m_num_coeffs + (m_block_switching ? 1 : 0); }
+    
+    /**
+     * @brief Detetor de transientes da comutação de blocos (razão de energias)
+     * @param samples Primeira amostra do bloco; as N/DCT_SHORT_BLOCKS + 1 amostras
+     *        anteriores também são lidas
+     * @param actual_samples Amostras válidas do bloco
+     * @return true se o bloco deve ser codificado como curto
+     */
+    bool detect_transient(const short* samples, int actual_samples) const;
+    
+    /**
+     * @brief DCT/IDCT de um bloco curto: DCT_SHORT_BLOCKS transformadas de
+     *        N/DCT_SHORT_BLOCKS amostras, com os coeficientes intercalados
+     */
+    std::vector<double> apply_short_dct(const std::vector<short>& samples);
+    std::vector<short> apply_short_idct(const std::vector<double>& coeffs);
+    
+    /**
+     * @brief Número de coeficientes escritos de um bloco (até ao último não nulo com EOB)
+     */
+    int coded_coeffs(const int* coeffs) const;
+    
+    /**
+     * @brief Calcula os valores de um bloco antes da quantização: DC (média
+     *        arredondada) seguido dos m_num_coeffs primeiros coeficientes DCT
+     *
+     * Na MDCT o DC é sempre 0 (a média não pode ser tirada bloco a bloco sem
+     * estragar o cancelamento do aliasing) e samples é o início das 2N amostras
+     * da trama, todas válidas.
+     * @param samples Primeira amostra do bloco
+     * @param actual_samples Amostras válidas (o resto do bloco é preenchido com zeros)
+     * @param values Destino (values_per_block() valores)
+     * @return Energia dos coeficientes descartados (k >= m_num_coeffs)
+     */
+    double analyze_block(const short* samples, int actual_samples, double* values);
+    
+    /**
+     * @brief Quantiza os valores de num_blocks blocos consecutivos com um passo
+     *        (multiplicado pelo peso de cada coeficiente)
+     */
+    void quantize_blocks(const double* values, int num_blocks, double step, int* quantized) const;
+    
+    /**
+     * @brief Passo (em 1/DCT_STEP_SCALE) de um segmento com controlo de débito ou
+     *        de SNR, por bisseção sobre os valores já transformados
+     *
+     * Com débito alvo é o menor passo cujo segmento (contado com um BitCounter) cabe
+     * em budget_bits; com SNR alvo é o maior passo cujo ruído de quantização,
+     * calculado no domínio da DCT (ortonormal), mais noise_floor, fica abaixo do alvo.
+     * Em RAW o passo mínimo é o que mantém os coeficientes até DCT_RAW_MAX e, como o
+     * número de bits não depende do passo, com débito alvo é esse o passo escolhido.
+     * @param values Valores dos canais do segmento, o canal c em values + c * stride
+     */
+    int choose_step(const double* values, size_t stride, int num_blocks, double budget_bits,
+                    double signal_energy, double noise_floor);
+    
+    /**
+     * @brief Codifica os blocos de um segmento (com a tabela de Huffman, se for o caso)
+     * @param quantized Valores de num_blocks blocos, consecutivos
+     * @param out Buffer de bits (ou BitCounter) onde o segmento é acrescentado
+     */
+    template <typename Writer>
+    void encode_segment(const int* quantized, int num_blocks, Writer& out);
+    
+    /**
+     * @brief Escreve os valores quantizados de um bloco
+     * @param rice Contextos do segmento (usados em RICE e HUFFMAN)
+     * @param huffman Códigos do segmento, um por banda (só usados em HUFFMAN)
+     */
+    template <typename Writer>
+    void write_block(Writer& out, const int* quantized, RiceContext& rice,
+                     const std::vector<HuffmanCode>& huffman);
+    
+    /**
+     * @brief Lê os valores quantizados de um bloco (DC seguido dos coeficientes)
+     */
+    void read_block(BitStream& bs, int* quantized, RiceContext& rice,
+                    const std::vector<HuffmanCode>& huffman);
+    
+    /**
+     * @brief Separa amostras intercaladas em canais consecutivos (MID/SIDE em estéreo
+     *        se m_mid_side)
+     * @param frames Amostras por canal
+     * @param planar Destino: canal c começa em planar + c * stride
+     */
+    void split_channels(const short* interleaved, int frames, short* planar, size_t stride) const;
+    
+    /**
+     * @brief Operação inversa de split_channels
+     */
+    void join_channels(const short* planar, size_t stride, int frames, short* interleaved) const;
+    
+    /**
+     * @brief Reconstrói um bloco a partir dos valores lidos do ficheiro
+     * @param quantized DC seguido dos m_num_coeffs coeficientes quantizados (e do
+     *        tipo do bloco)
+     * @param out Destino das amostras
+     * @param actual_samples Amostras do bloco a escrever em out
+     * @param step Passo de quantização do segmento (antes dos pesos dos coeficientes)
+     */
+    void decode_block(const int* quantized, short* out, int actual_samples, double step);
+    
+    /**
+     * @brief Dequantiza uma trama MDCT e calcula a sua IMDCT com janela
+     * @param out Destino das 2N amostras a sobrepor às das tramas vizinhas
+     */
+    void decode_frame(const int* quantized, double* out, double step);
+    
+    /**
+     * @brief DCT/IDCT pela soma direta (O(N²))
+     */
+    std::vector<double> apply_dct_naive(const std::vector<short>& samples) const;
+    std::vector<double> apply_idct_naive(const std::vector<double>& coeffs) const;
+    
+    /**
+     * @brief DCT/IDCT como produto pela matriz de cossenos pré-calculada
+     */
+    std::vector<double> apply_dct_matrix(const std::vector<short>& samples);
+    std::vector<double> apply_idct_matrix(const std::vector<double>& coeffs);
+    
+    /**
+     * @brief DCT/IDCT através de uma FFT de N pontos (O(N log N))
+     */
+    std::vector<double> apply_dct_fft(const std::vector<short>& samples);
+    std::vector<double> apply_idct_fft(const std::vector<double>& coeffs);
+    
+    /**
+     * @brief DCT-IV ortonormal de N pontos (núcleo da MDCT e da IMDCT, é a sua
+     *        própria inversa): pela FFT complexa de N/2 pontos para N potência de 2,
+     *        pela tabela de cossenos (ou soma direta) para os restantes
+     */
+    void apply_dct4(const double* in, double* out);
+    void dct4_fft(const double* in, double* out);
+    void dct4_matrix(const double* in, double* out);
     
     /**
      * @brief Quantiza um coeficiente DCT
      * @param coeff Coeficiente DCT
+     * @param step Passo de quantização (Q, ou o passo do segmento)
      * @return Coeficiente quantizado (inteiro)
      */
-    int quantize(double coeff);
+    int quantize(double coeff, double step) const;
     
     /**
      * @brief Dequantiza um coeficiente
      * @param quantized_coeff Coeficiente quantizado
+     * @param step Passo de quantização
      * @return Coeficiente dequantizado
      */
-    double dequantize(int quantized_coeff);
+    double dequantize(int quantized_coeff, double step) const;
 
 public:
     /**
@@ -62,6 +451,7 @@ public:
      * @param quantization_factor Fator de quantização (Q)
      */
     DCTCodec(int block_size, int num_coeffs, int quantization_factor);
+    ~DCTCodec();
     
     /**
      * @brief Codifica um ficheiro de áudio WAV
@@ -79,50 +469,186 @@ public:
      */
     bool decode(const std::string& input_file, const std::string& output_file);
     
+    /**
+     * @brief Descodifica só um troço de um ficheiro .dct
+     *
+     * Com índice de segmentos só se lê e descodifica desde o início do segmento que
+     * contém start_sample; sem índice (ficheiros antigos) descodifica-se desde o
+     * início do ficheiro e descarta-se o que fica antes do troço.
+     * @param start_sample Primeira amostra (por canal) do troço
+     * @param num_samples Amostras por canal pedidas (cortadas no fim do ficheiro)
+     * @param samples Destino: amostras intercaladas por canal
+     * @return true se sucesso, false caso contrário
+     */
+    bool decode_range(const std::string& input_file, uint32_t start_sample, uint32_t num_samples,
+                      std::vector<short>& samples);
+    
+    /**
+     * @brief Aplica DCT (Discrete Cosine Transform) a um bloco de amostras
+     * @param samples Vetor com as amostras do bloco
+     * @return Vetor com os coeficientes DCT (escala ortonormal)
+     */
+    std::vector<double> apply_dct(const std::vector<short>& samples);
+    
+    /**
+     * @brief Aplica IDCT (Inverse DCT) aos coeficientes
+     * @param coeffs Vetor com os coeficientes DCT
+     * @return Vetor com as amostras reconstruídas
+     */
+    std::vector<short> apply_idct(const std::vector<double>& coeffs);
+    
+    /**
+     * @brief MDCT de uma trama
+     * @param samples 2N amostras (o bloco anterior e o bloco atual)
+     * @return N coeficientes (escala ortonormal: com a janela, a transformada
+     *         sobreposta conserva a energia)
+     */
+    std::vector<double> apply_mdct(const std::vector<short>& samples);
+    
+    /**
+     * @brief IMDCT de uma trama, já multiplicada pela janela
+     * @param coeffs N coeficientes
+     * @return 2N valores; a soma da segunda metade de uma trama com a primeira
+     *         metade da seguinte reconstrói o bloco comum
+     */
+    std::vector<double> apply_imdct(const std::vector<double>& coeffs);
+    
+    /**
+     * @brief Escolhe a implementação da transformada (default: AUTO)
+     *
+     * Só se aplica à DCT; a MDCT usa sempre a FFT de N/2 pontos quando N é
+     * potência de 2 (N >= 4) e a tabela de cossenos nos outros casos.
+     */
+    void set_engine(DCTEngine engine) { m_engine = engine; }
+    
+    /**
+     * @brief Escolhe a transformada (default: DCT); a MDCT exige block_size par
+     */
+    void set_transform(DCTTransform transform) { m_transform = transform; }
+    
+    /**
+     * @brief Ativa a comutação de blocos longos/curtos (default: desligada)
+     *
+     * Os blocos com um transiente são codificados como DCT_SHORT_BLOCKS blocos curtos,
+     * o que confina o pré-eco ao sub-bloco do ataque; os restantes continuam longos.
+     * A decisão é tomada bloco a bloco, na mesma tarefa que calcula a DCT, e só olha
+     * para as amostras do próprio bloco e do fim do anterior, pelo que o ficheiro não
+     * depende do número de threads. Só com a DCT e block_size múltiplo de
+     * DCT_SHORT_BLOCKS (pelo menos 2 * DCT_SHORT_BLOCKS).
+     */
+    void set_block_switching(bool block_switching) { m_block_switching = block_switching; }
+    
+    /**
+     * @brief Escolhe a codificação dos valores quantizados (default: RAW)
+     */
+    void set_coding(DCTCoding coding) { m_coding = coding; }
+    
+    /**
+     * @brief Ativa a codificação por corridas de zeros com end-of-block (default: desligada)
+     *
+     * Cada bloco começa pelo número de coeficientes até ao último não nulo (EOB)
+     * e a cauda de zeros não é escrita. Em RAW cada valor não nulo é precedido
+     * do número de zeros antes dele, em vez de 16 bits por zero. As contagens
+     * usam Golomb-Rice adaptativo.
+     */
+    void set_eob(bool eob) { m_eob = eob; }
+    
+    /**
+     * @brief Guarda ficheiros estéreo como MID/SIDE (default: desligado; ignorado
+     *        para outros números de canais)
+     */
+    void set_mid_side(bool mid_side) { m_mid_side = mid_side; }
+    
+    /**
+     * @brief Escreve o índice de segmentos usado por decode_range (default: desligado)
+     */
+    void set_seek_index(bool seek_index) { m_seek_index = seek_index; }
+    
+    /**
+     * @brief Débito alvo em kbps (0 = desligado, usa o Q fixo)
+     *
+     * O passo de quantização passa a ser escolhido por segmento (comum aos canais)
+     * de forma a gastar o débito alvo; o que sobra ou falta num lote é somado ao
+     * orçamento do lote seguinte. Desliga o SNR alvo.
+     */
+    void set_target_bitrate(double kbps) { m_target_kbps = kbps; m_target_snr = 0.0; }
+    
+    /**
+     * @brief SNR alvo em dB (0 = desligado): cada segmento usa o maior passo de
+     *        quantização que o atinge. Desliga o débito alvo.
+     */
+    void set_target_snr(double snr_db) { m_target_snr = snr_db; m_target_kbps = 0.0; }
+    
+    /**
+     * @brief Escolhe a matriz de quantização (default: FLAT)
+     *
+     * Os pesos são calculados em encode (a matriz perceptual depende da taxa de
+     * amostragem) e guardados no cabeçalho, pelo que o descodificador não precisa
+     * de saber qual foi usada.
+     */
+    void set_quant_matrix(DCTMatrix matrix) { m_matrix = matrix; }
+    
+    /**
+     * @brief Passa a usar a matriz CUSTOM com os pesos dados (multiplicadores do
+     *        passo, de 1/16 a 255/16); os coeficientes a mais que os pesos usam o último
+     */
+    void set_quant_matrix(const std::vector<double>& weights) {
+        m_matrix_table = weights;
+        m_matrix = weights.empty() ? DCTMatrix::FLAT : DCTMatrix::CUSTOM;
+    }
+    
+    /**
+     * @brief Lê os pesos de uma matriz de um ficheiro de texto: um peso por
+     *        coeficiente, separados por espaços ou linhas; '#' começa um comentário
+     * @return false (mensagem em cerr) se o ficheiro não existir ou tiver valores inválidos
+     */
+    static bool read_quant_matrix(const std::string& filename, std::vector<double>& weights);
+    
+    /**
+     * @brief Número de threads usadas por encode/decode (default: 1, 0 = número de cores)
+     *
+     * Os blocos são independentes: cada tarefa codifica um segmento de
+     * DCT_SEGMENT_BLOCKS blocos de um canal para o seu buffer e os buffers são escritos
+     * por ordem, pelo que o ficheiro é idêntico para qualquer número de threads.
+     */
+    void set_num_threads(int num_threads);
+    
+    /**
+     * @brief Usa um pool partilhado com outros codecs (nullptr = sem threads)
+     *
+     * O pool tem de existir enquanto o codec o usar. Chamado dentro de uma tarefa do
+     * mesmo pool (ex.: um ficheiro no dct_batch), os segmentos do ficheiro são
+     * tarefas desse pool e as threads livres roubam-nas.
+     */
+    void set_thread_pool(ThreadPool* pool);
+    
+    /**
+     * @brief Mostra parâmetros e estatísticas em cout durante encode/decode (default: sim)
+     */
+    void set_verbose(bool verbose) { m_verbose = verbose; }
+    
     // Getters
     int get_block_size() const { return m_block_size; }
     int get_num_coeffs() const { return m_num_coeffs; }
     int get_quantization_factor() const { return m_quantization_factor; }
+    DCTEngine get_engine() const { return m_engine; }
+    DCTTransform get_transform() const { return m_transform; }
+    bool get_block_switching() const { return m_block_switching; }
+    DCTCoding get_coding() const { return m_coding; }
+    bool get_eob() const { return m_eob; }
+    bool get_mid_side() const { return m_mid_side; }
+    bool get_seek_index() const { return m_seek_index; }
+    double get_target_bitrate() const { return m_target_kbps; }
+    double get_target_snr() const { return m_target_snr; }
+    DCTMatrix get_quant_matrix() const { return m_matrix; }
+    const std::vector<int>& get_weights() const { return m_weights; }
+    int get_num_channels() const { return m_num_channels; }
+    int get_sample_rate() const { return m_sample_rate; }
+    uint32_t get_total_samples() const { return m_total_samples; }
+    int get_num_threads() const { return m_num_threads; }
     
     // Método de teste público para validação
     double test_roundtrip(const std::vector<short>& samples);
 };
 
-/**
- * @brief Estrutura para armazenar cabeçalho WAV simplificado (mono, 16-bit)
- */
-struct WAVHeader {
-    char riff[4];              // "RIFF"
-    int file_size;             // Tamanho do ficheiro - 8
-    char wave[4];              // "WAVE"
-    char fmt[4];               // "fmt "
-    int fmt_size;              // 16 para PCM
-    short audio_format;        // 1 para PCM
-    short num_channels;        // 1 para mono
-    int sample_rate;           // Ex: 44100
-    int byte_rate;             // sample_rate * num_channels * bits_per_sample / 8
-    short block_align;         // num_channels * bits_per_sample / 8
-    short bits_per_sample;     // 16
-    char data[4];              // "data"
-    int data_size;             // Tamanho dos dados de áudio
-};
-
-/**
- * @brief Lê cabeçalho e amostras de um ficheiro WAV mono 16-bit
- * @param filename Nome do ficheiro WAV
- * @param header Estrutura para armazenar o cabeçalho
- * @param samples Vetor para armazenar as amostras
- * @return true se sucesso, false caso contrário
- */
-bool read_wav_file(const std::string& filename, WAVHeader& header, std::vector<short>& samples);
-
-/**
- * @brief Escreve cabeçalho e amostras para um ficheiro WAV mono 16-bit
- * @param filename Nome do ficheiro WAV
- * @param header Cabeçalho WAV
- * @param samples Vetor com as amostras
- * @return true se sucesso, false caso contrário
- */
-bool write_wav_file(const std::string& filename, const WAVHeader& header, const std::vector<short>& samples);
-
 #endif
@@ -7,6 +7,8 @@
 #include "dct_codec.h"
 #include <iostream>
 #include <string>
+#include <vector>
+#include <cstdlib>
 
 using namespace std;
 
@@ -17,27 +19,72 @@ int main(int argc, char* argv[]) {
     cout << "DCT Audio Decoder" << endl;
     cout << "=================" << endl;
     
+    // Separar opções dos argumentos posicionais
+    vector<string> args;
+    int num_threads = 1;
+    bool range = false;
+    uint32_t start_sample = 0;
+    uint32_t num_samples = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+        } else if (arg == "-r" && i + 2 < argc) {
+            range = true;
+            start_sample = strtoul(argv[++i], nullptr, 10);
+            num_samples = strtoul(argv[++i], nullptr, 10);
+        } else {
+            args.push_back(arg);
+        }
+    }
+    
     // Verificar argumentos
-    if (argc < 3) {
-        cout << "\nUso: " << argv[0] << " <input.dct> <output.wav>" << endl;
+    if (args.size() < 2 || num_threads < 0) {
+        cout << "\nUso: " << argv[0] << " [-j threads] [-r start num] <input.dct> <output.wav>" << endl;
         cout << "\nExemplo:" << endl;
         cout << "  " << argv[0] << " audio.dct audio_decoded.wav" << endl;
+        cout << "  " << argv[0] << " -r 2646000 441000 audio.dct excerto.wav" << endl;
+        cout << "\nOpções:" << endl;
+        cout << "  -j threads  - Threads de descodificação (default: 1, 0 = todos os cores)" << endl;
+        cout << "  -r start num - Só as amostras (por canal) start .. start+num-1; rápido em" << endl;
+        cout << "                ficheiros codificados com índice (dct_encoder -i)" << endl;
         return 1;
     }
     
-    string input_file = argv[1];
-    string output_file = argv[2];
+    string input_file = args[0];
+    string output_file = args[1];
     
     cout << "\nParâmetros:" << endl;
     cout << "  Input:  " << input_file << endl;
     cout << "  Output: " << output_file << endl;
+    cout << "  Threads: " << num_threads << endl;
+    if (range) {
+        cout << "  Troço: " << num_samples << " amostras a partir de " << start_sample << endl;
+    }
     cout << endl;
     
     // Criar codec e descodificar
     // Os parâmetros serão lidos do ficheiro .dct
     DCTCodec codec(512, 256, 2); // Valores temporários, serão substituídos
+    codec.set_num_threads(num_threads);
     
-    if (!codec.decode(input_file, output_file)) {
+    if (range) {
+        vector<short> samples;
+        WAVWriter writer;
+        if (!codec.decode_range(input_file, start_sample, num_samples, samples) ||
+            !writer.open(output_file, codec.get_sample_rate(), codec.get_num_channels())) {
+            cerr << "\nErro durante a descodificação!" << endl;
+            return 1;
+        }
+        writer.write(samples.data(), samples.size());
+        if (!writer.close()) {
+            cerr << "\nErro: falha ao escrever " << output_file << endl;
+            return 1;
+        }
+        cout << "Troço descodificado: " << samples.size() / codec.get_num_channels() << " amostras"
+             << (codec.get_seek_index() ? "" : " (sem índice: descodificado desde o início)") << endl;
+    } else if (!codec.decode(input_file, output_file)) {
         cerr << "\nErro durante a descodificação!" << endl;
         return 1;
     }
@@ -7,6 +7,8 @@
 #include "dct_codec.h"
 #include <iostream>
 #include <string>
+#include <vector>
+#include <cstdlib>
 
 using namespace std;
 
@@ -17,26 +19,109 @@ int main(int argc, char* argv[]) {
     cout << "DCT Audio Encoder" << endl;
     cout << "=================" << endl;
     
+    // Separar opções dos argumentos posicionais
+    vector<string> args;
+    int num_threads = 1;
+    DCTCoding coding = DCTCoding::RAW;
+    bool eob = false;
+    bool mid_side = false;
+    bool seek_index = false;
+    double target_kbps = 0.0;
+    double target_snr = 0.0;
+    string matrix = "flat";
+    DCTTransform transform = DCTTransform::DCT;
+    bool block_switching = false;
+    bool bad_option = false;
+    
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+        } else if (arg == "-c" && i + 1 < argc) {
+            string name = argv[++i];
+            if (name == "raw") coding = DCTCoding::RAW;
+            else if (name == "rice") coding = DCTCoding::RICE;
+            else if (name == "huffman") coding = DCTCoding::HUFFMAN;
+            else bad_option = true;
+        } else if (arg == "-e") {
+            eob = true;
+        } else if (arg == "-m") {
+            mid_side = true;
+        } else if (arg == "-i") {
+            seek_index = true;
+        } else if (arg == "-b" && i + 1 < argc) {
+            target_kbps = atof(argv[++i]);
+            if (target_kbps <= 0.0) bad_option = true;
+        } else if (arg == "-s" && i + 1 < argc) {
+            target_snr = atof(argv[++i]);
+            if (target_snr <= 0.0) bad_option = true;
+        } else if (arg == "-w" && i + 1 < argc) {
+            matrix = argv[++i];
+        } else if (arg == "-t" && i + 1 < argc) {
+            string name = argv[++i];
+            if (name == "dct") transform = DCTTransform::DCT;
+            else if (name == "mdct") transform = DCTTransform::MDCT_SINE;
+            else if (name == "mdct-kbd") transform = DCTTransform::MDCT_KBD;
+            else bad_option = true;
+        } else if (arg == "-a") {
+            block_switching = true;
+        } else {
+            args.push_back(arg);
+        }
+    }
+    // Débito alvo e SNR alvo são alternativos (set_target_snr anula o débito)
+    if (target_kbps > 0.0 && target_snr > 0.0) bad_option = true;
+    
     // Verificar argumentos
-    if (argc < 3) {
-        cout << "\nUso: " << argv[0] << " <input.wav> <output.dct> [block_size] [num_coeffs] [quant_factor]" << endl;
+    if (args.size() < 2 || num_threads < 0 || bad_option) {
+        cout << "\nUso: " << argv[0] << " [-j threads] [-c raw|rice|huffman] [-e] [-m] [-i] [-b kbps | -s dB] [-w matriz] [-t transformada] [-a] <input.wav> <output.dct> [block_size] [num_coeffs] [quant_factor]" << endl;
         cout << "\nParâmetros opcionais:" << endl;
         cout << "  block_size     - Tamanho do bloco (default: 512)" << endl;
         cout << "  num_coeffs     - Número de coeficientes DCT (default: 256)" << endl;
         cout << "  quant_factor   - Fator de quantização (default: 2)" << endl;
+        cout << "\nOpções:" << endl;
+        cout << "  -j threads     - Threads de codificação (default: 1, 0 = todos os cores)" << endl;
+        cout << "  -c raw|rice|huffman - Codificação dos coeficientes: 16 bits fixos, Golomb-Rice" << endl;
+        cout << "                   adaptativo ou Huffman canónico com uma tabela por segmento" << endl;
+        cout << "                   (default: raw, legível por descodificadores antigos)" << endl;
+        cout << "  -e             - Corridas de zeros + end-of-block (não escreve a cauda de zeros)" << endl;
+        cout << "  -m             - Estéreo como MID/SIDE (canais correlacionados)" << endl;
+        cout << "  -i             - Índice de segmentos para acesso aleatório (dct_decoder -r)" << endl;
+        cout << "  -b kbps        - Débito alvo: passo de quantização escolhido por segmento" << endl;
+        cout << "                   (quant_factor fica só como valor nominal; em raw o tamanho não" << endl;
+        cout << "                   depende do passo e fica o menor passo sem saturar os coeficientes)" << endl;
+        cout << "  -s dB          - SNR alvo: maior passo de quantização que o atinge em cada segmento" << endl;
+        cout << "                   (não pode ser usado com -b)" << endl;
+        cout << "  -w matriz      - Matriz de quantização: flat (default), perceptual (passo maior" << endl;
+        cout << "                   nas altas frequências) ou ficheiro de texto com um peso por coeficiente" << endl;
+        cout << "  -t dct|mdct|mdct-kbd - Transformada: DCT por bloco (default) ou MDCT com" << endl;
+        cout << "                   sobreposição de 50% e janela seno ou KBD (sem efeito de bloco)" << endl;
+        cout << "  -a             - Comutação de blocos: blocos com transientes divididos em 8 DCTs" << endl;
+        cout << "                   curtas, para limitar o pré-eco (só com -t dct)" << endl;
         cout << "\nExemplos:" << endl;
         cout << "  " << argv[0] << " audio.wav audio.dct" << endl;
         cout << "  " << argv[0] << " audio.wav audio.dct 1024 128 10" << endl;
+        cout << "  " << argv[0] << " -j 16 audio.wav audio.dct" << endl;
+        cout << "  " << argv[0] << " -c rice audio.wav audio.dct 1024 128 10" << endl;
+        cout << "  " << argv[0] << " -c rice -e audio.wav audio.dct 1024 128 10" << endl;
+        cout << "  " << argv[0] << " -c huffman -e audio.wav audio.dct 256 256 100" << endl;
+        cout << "  " << argv[0] << " -c rice -m stereo.wav stereo.dct 1024 256 10" << endl;
+        cout << "  " << argv[0] << " -c rice -i audio.wav audio.dct 1024 256 10" << endl;
+        cout << "  " << argv[0] << " -c huffman -e -b 96 audio.wav audio.dct 1024 256" << endl;
+        cout << "  " << argv[0] << " -c rice -e -s 30 audio.wav audio.dct 1024 256" << endl;
+        cout << "  " << argv[0] << " -c rice -e -w perceptual audio.wav audio.dct 256 256 20" << endl;
+        cout << "  " << argv[0] << " -c rice -e -t mdct -b 64 audio.wav audio.dct 1024 1024" << endl;
+        cout << "  " << argv[0] << " -c rice -e -a audio.wav audio.dct 1024 256 10" << endl;
         return 1;
     }
     
-    string input_file = argv[1];
-    string output_file = argv[2];
+    string input_file = args[0];
+    string output_file = args[1];
     
     // Parâmetros do codec (com valores default)
-    int block_size = (argc > 3) ? atoi(argv[3]) : 512;
-    int num_coeffs = (argc > 4) ? atoi(argv[4]) : 256;
-    int quant_factor = (argc > 5) ? atoi(argv[5]) : 2;
+    int block_size = (args.size() > 2) ? atoi(args[2].c_str()) : 512;
+    int num_coeffs = (args.size() > 3) ? atoi(args[3].c_str()) : 256;
+    int quant_factor = (args.size() > 4) ? atoi(args[4].c_str()) : 2;
     
     // Validar parâmetros
     if (block_size <= 0 || num_coeffs <= 0 || quant_factor <= 0) {
@@ -55,10 +140,34 @@ int main(int argc, char* argv[]) {
     cout << "  Block size: " << block_size << endl;
     cout << "  Num coeffs: " << num_coeffs << endl;
     cout << "  Quant factor: " << quant_factor << endl;
+    cout << "  Threads: " << num_threads << endl;
+    cout << "  Coding: " << (coding == DCTCoding::RICE ? "rice" : coding == DCTCoding::HUFFMAN ? "huffman" : "raw") << (eob ? " + eob" : "") << (mid_side ? " + mid/side" : "") << (seek_index ? " + index" : "") << endl;
+    if (target_kbps > 0.0) cout << "  Target bitrate: " << target_kbps << " kbps" << endl;
+    if (target_snr > 0.0) cout << "  Target SNR: " << target_snr << " dB" << endl;
+    cout << "  Matrix: " << matrix << endl;
+    cout << "  Transform: " << (transform == DCTTransform::MDCT_KBD ? "mdct-kbd" : transform == DCTTransform::MDCT_SINE ? "mdct" : "dct") << (block_switching ? " + block switching" : "") << endl;
     cout << endl;
     
     // Criar codec e codificar
     DCTCodec codec(block_size, num_coeffs, quant_factor);
+    codec.set_num_threads(num_threads);
+    codec.set_coding(coding);
+    codec.set_eob(eob);
+    codec.set_mid_side(mid_side);
+    codec.set_seek_index(seek_index);
+    codec.set_transform(transform);
+    codec.set_block_switching(block_switching);
+    if (target_kbps > 0.0) codec.set_target_bitrate(target_kbps);
+    if (target_snr > 0.0) codec.set_target_snr(target_snr);
+    if (matrix == "perceptual") {
+        codec.set_quant_matrix(DCTMatrix::PERCEPTUAL);
+    } else if (matrix != "flat") {
+        vector<double> weights;
+        if (!DCTCodec::read_quant_matrix(matrix, weights)) {
+            return 1;
+        }
+        codec.set_quant_matrix(weights);
+    }
     
     if (!codec.encode(input_file, output_file)) {
         cerr << "\nErro durante a codificação!" << endl;
@@ -0,0 +1,165 @@
+//-------------------------------------------------------------------------------------------
+//
+// DCT Kernels - Implementação
+//
+// As versões SIMD são compiladas com atributos target() em vez de flags globais,
+// pelo que o binário continua a correr em qualquer CPU x86-64 (e noutras
+// arquiteturas/compiladores só existe a versão escalar).
+//
+//-------------------------------------------------------------------------------------------
+
+#include "dct_kernels.h"
+#include <atomic>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define DCT_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+//-------------------------------------------------------------------------------------------
+// Escalar
+//-------------------------------------------------------------------------------------------
+static double dot_scalar(const double* a, const double* b, int n) {
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+static void axpy_scalar(double alpha, const double* x, double* y, int n) {
+    for (int i = 0; i < n; i++) {
+        y[i] += alpha * x[i];
+    }
+}
+
+#ifdef DCT_KERNELS_X86
+
+//-------------------------------------------------------------------------------------------
+// SSE4.2 (2 doubles por registo)
+//-------------------------------------------------------------------------------------------
+__attribute__((target("sse4.2")))
+static double dot_sse42(const double* a, const double* b, int n) {
+    __m128d acc0 = _mm_setzero_pd();
+    __m128d acc1 = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+    }
+    acc0 = _mm_add_pd(acc0, acc1);
+    double sum = _mm_cvtsd_f64(_mm_add_sd(acc0, _mm_unpackhi_pd(acc0, acc0)));
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+__attribute__((target("sse4.2")))
+static void axpy_sse42(double alpha, const double* x, double* y, int n) {
+    __m128d va = _mm_set1_pd(alpha);
+    int i = 0;
+    for (; i + 2 <= n; i += 2) {
+        _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(va, _mm_loadu_pd(x + i))));
+    }
+    for (; i < n; i++) {
+        y[i] += alpha * x[i];
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// AVX2 + FMA (4 doubles por registo, 4 acumuladores independentes)
+//-------------------------------------------------------------------------------------------
+__attribute__((target("avx2,fma")))
+static double dot_avx2(const double* a, const double* b, int n) {
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    __m256d acc2 = _mm256_setzero_pd();
+    __m256d acc3 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+        acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), acc1);
+        acc2 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 8), _mm256_loadu_pd(b + i + 8), acc2);
+        acc3 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 12), _mm256_loadu_pd(b + i + 12), acc3);
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), acc0);
+    }
+    __m256d acc = _mm256_add_pd(_mm256_add_pd(acc0, acc1), _mm256_add_pd(acc2, acc3));
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(acc), _mm256_extractf128_pd(acc, 1));
+    double sum = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+__attribute__((target("avx2,fma")))
+static void axpy_avx2(double alpha, const double* x, double* y, int n) {
+    __m256d va = _mm256_set1_pd(alpha);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+        _mm256_storeu_pd(y + i + 4, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+    }
+    for (; i + 4 <= n; i += 4) {
+        _mm256_storeu_pd(y + i, _mm256_fmadd_pd(va, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+    }
+    for (; i < n; i++) {
+        y[i] += alpha * x[i];
+    }
+}
+
+#endif
+
+//-------------------------------------------------------------------------------------------
+// Seleção
+//-------------------------------------------------------------------------------------------
+static const DCTKernels scalar_kernels = { KernelISA::SCALAR, "escalar", dot_scalar, axpy_scalar };
+#ifdef DCT_KERNELS_X86
+static const DCTKernels sse42_kernels = { KernelISA::SSE42, "SSE4.2", dot_sse42, axpy_sse42 };
+static const DCTKernels avx2_kernels = { KernelISA::AVX2, "AVX2+FMA", dot_avx2, axpy_avx2 };
+#endif
+
+static std::atomic<const DCTKernels*> active_kernels { nullptr };
+
+KernelISA detect_kernel_isa() {
+#ifdef DCT_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return KernelISA::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return KernelISA::SSE42;
+    }
+#endif
+    return KernelISA::SCALAR;
+}
+
+static const DCTKernels* kernels_for(KernelISA isa) {
+#ifdef DCT_KERNELS_X86
+    if (isa == KernelISA::AVX2) return &avx2_kernels;
+    if (isa == KernelISA::SSE42) return &sse42_kernels;
+#else
+    (void)isa;
+#endif
+    return &scalar_kernels;
+}
+
+const DCTKernels& dct_kernels() {
+    const DCTKernels* kernels = active_kernels.load(std::memory_order_acquire);
+    if (kernels == nullptr) {
+        kernels = kernels_for(detect_kernel_isa());
+        active_kernels.store(kernels, std::memory_order_release);
+    }
+    return *kernels;
+}
+
+void set_kernel_isa(KernelISA isa) {
+    KernelISA best = detect_kernel_isa();
+    if (static_cast<int>(isa) > static_cast<int>(best)) {
+        isa = best;
+    }
+    active_kernels.store(kernels_for(isa), std::memory_order_release);
+}
@@ -0,0 +1,51 @@
+//-------------------------------------------------------------------------------------------
+//
+// DCT Kernels - Produtos internos e axpy vetorizados para a transformada matricial
+// Seleção em tempo de execução entre AVX2+FMA, SSE4.2 e código escalar
+//
+//-------------------------------------------------------------------------------------------
+
+#ifndef DCT_KERNELS_H
+#define DCT_KERNELS_H
+
+/**
+ * @brief Conjuntos de instruções suportados pelos kernels (por ordem de preferência)
+ */
+enum class KernelISA {
+    SCALAR,
+    SSE42,
+    AVX2
+};
+
+/**
+ * @brief Tabela de funções de um conjunto de instruções
+ *
+ * dot:  retorna sum(a[i] * b[i]), i < n
+ * axpy: y[i] += alpha * x[i], i < n
+ */
+struct DCTKernels {
+    KernelISA isa;
+    const char* name;
+    double (*dot)(const double* a, const double* b, int n);
+    void (*axpy)(double alpha, const double* x, double* y, int n);
+};
+
+/**
+ * @brief Melhor conjunto de instruções suportado pelo CPU
+ */
+KernelISA detect_kernel_isa();
+
+/**
+ * @brief Kernels em uso (na primeira chamada escolhe os de detect_kernel_isa())
+ */
+const DCTKernels& dct_kernels();
+
+/**
+ * @brief Força um conjunto de instruções (limitado ao que o CPU suporta)
+ *
+ * Destina-se a testes e benchmarks; não deve ser chamado enquanto outras
+ * threads estão a usar o codec.
+ */
+void set_kernel_isa(KernelISA isa);
+
+#endif
@@ -6,6 +6,7 @@
 //-------------------------------------------------------------------------------------------
 
 #include "dct_codec.h"
+#include "dct_kernels.h"
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -13,19 +14,35 @@
 #include <iomanip>
 #include <filesystem>
 #include <chrono>
+#include <algorithm>
 
 using namespace std;
 namespace fs = std::filesystem;
 
+/**
+ * @brief Parâmetros do codec num teste (os campos omitidos ficam com o default do codec)
+ */
+struct TestOptions {
+    string name;
+    int block_size;
+    int num_coeffs;
+    int quant_factor;
+    DCTCoding coding = DCTCoding::RAW;
+    bool eob = false;
+    bool mid_side = false;
+    double target_kbps = 0.0;                   // Débito alvo (0 = quant_factor fixo)
+    double target_snr = 0.0;                    // SNR alvo (0 = quant_factor fixo)
+    DCTMatrix matrix = DCTMatrix::FLAT;         // Matriz de quantização
+    DCTTransform transform = DCTTransform::DCT; // DCT ou MDCT
+    bool block_switching = false;               // Blocos curtos nos transientes
+};
+
 /**
  * @brief Estrutura para armazenar resultados de um teste
  */
 struct TestResult {
-    string test_name;
+    TestOptions options;
     string input_file;
-    int block_size;
-    int num_coeffs;
-    int quantization_factor;
     
     // Métricas
     double bitrate;           // bits por segundo
@@ -74,21 +91,15 @@ double calculate_snr(const vector<short>& original, const vector<short>& reconst
 /**
  * @brief Executa um teste completo com parâmetros específicos
  * @param input_wav Ficheiro de entrada WAV
- * @param test_name Nome do teste
- * @param block_size Tamanho do bloco
- * @param num_coeffs Número de coeficientes
- * @param quant_factor Fator de quantização
+ * @param options Nome do teste e parâmetros do codec
  * @return Estrutura com os resultados do teste
  */
-TestResult run_test(const string& input_wav, const string& test_name,
-                    int block_size, int num_coeffs, int quant_factor) {
+TestResult run_test(const string& input_wav, const TestOptions& options) {
+    const string& test_name = options.name;
     
     TestResult result;
-    result.test_name = test_name;
+    result.options = options;
     result.input_file = input_wav;
-    result.block_size = block_size;
-    result.num_coeffs = num_coeffs;
-    result.quantization_factor = quant_factor;
     
     cout << "\n========================================" << endl;
     cout << "Teste: " << test_name << endl;
@@ -110,7 +121,15 @@ TestResult run_test(const string& input_wav, const string& test_name,
     }
     
     // Criar codec
-    DCTCodec codec(block_size, num_coeffs, quant_factor);
+    DCTCodec codec(options.block_size, options.num_coeffs, options.quant_factor);
+    codec.set_coding(options.coding);
+    codec.set_eob(options.eob);
+    codec.set_mid_side(options.mid_side);
+    if (options.target_kbps > 0.0) codec.set_target_bitrate(options.target_kbps);
+    if (options.target_snr > 0.0) codec.set_target_snr(options.target_snr);
+    codec.set_quant_matrix(options.matrix);
+    codec.set_transform(options.transform);
+    codec.set_block_switching(options.block_switching);
     
     // Medir tempo de codificação
     auto start_encode = chrono::high_resolution_clock::now();
@@ -143,7 +162,8 @@ TestResult run_test(const string& input_wav, const string& test_name,
     read_wav_file(decoded_file, reconstructed_header, reconstructed_samples);
     
     // Calcular métricas
-    result.duration = static_cast<double>(original_samples.size()) / original_header.sample_rate;
+    result.duration = static_cast<double>(original_samples.size()) /
+                      (static_cast<double>(original_header.sample_rate) * original_header.num_channels);
     result.snr_db = calculate_snr(original_samples, reconstructed_samples);
     result.bitrate = (result.compressed_size * 8.0) / result.duration;
     
@@ -171,6 +191,62 @@ TestResult run_test(const string& input_wav, const string& test_name,
     return result;
 }
 
+/**
+ * @brief Verifica o acesso aleatório: troços lidos com decode_range (pelo índice de
+ *        segmentos) têm de coincidir com os mesmos troços da descodificação completa
+ * @return true se todos os troços coincidirem
+ */
+bool check_seek(const string& input_wav) {
+    string base_name = fs::path(input_wav).stem().string();
+    string encoded_file = "resultados_testes/" + base_name + "_seek.dct";
+    string decoded_file = "resultados_testes/" + base_name + "_seek_decoded.wav";
+    
+    DCTCodec codec(1024, 256, 10);
+    codec.set_coding(DCTCoding::RICE);
+    codec.set_seek_index(true);
+    
+    cout << "\n========================================" << endl;
+    cout << "Acesso aleatório: " << input_wav << endl;
+    cout << "========================================" << endl;
+    
+    WAVHeader header;
+    vector<short> full;
+    auto start_full = chrono::high_resolution_clock::now();
+    if (!codec.encode(input_wav, encoded_file) || !codec.decode(encoded_file, decoded_file) ||
+        !read_wav_file(decoded_file, header, full)) {
+        cerr << "Erro na codificação/descodificação!" << endl;
+        return false;
+    }
+    double full_time = chrono::duration<double>(chrono::high_resolution_clock::now() - start_full).count();
+    
+    // Troços de 1 s: início, a meio (sem alinhamento a blocos) e a passar o fim
+    uint32_t total = codec.get_total_samples();
+    uint32_t length = static_cast<uint32_t>(header.sample_rate);
+    int channels = codec.get_num_channels();
+    bool ok = true;
+    double range_time = 0.0;
+    
+    for (uint32_t start : { 0u, total / 2 + 123, total - min(total, length / 2) }) {
+        vector<short> samples;
+        auto t0 = chrono::high_resolution_clock::now();
+        bool decoded = codec.decode_range(encoded_file, start, length, samples);
+        range_time = max(range_time, chrono::duration<double>(chrono::high_resolution_clock::now() - t0).count());
+        
+        size_t from = static_cast<size_t>(start) * channels;
+        size_t to = min(full.size(), from + static_cast<size_t>(length) * channels);
+        if (!decoded || !equal(samples.begin(), samples.end(), full.begin() + from, full.begin() + to) ||
+            samples.size() != to - from) {
+            cerr << "Erro: troço a partir de " << start << " difere da descodificação completa" << endl;
+            ok = false;
+        }
+    }
+    
+    cout << fixed << setprecision(2);
+    cout << "Troços de 1 s: " << (ok ? "OK" : "ERRO") << " (até " << 1000.0 * range_time
+         << " ms cada; codificação + descodificação completa: " << full_time << " s)" << endl;
+    return ok;
+}
+
 /**
  * @brief Gera relatório em CSV com todos os resultados
  * @param results Vetor com todos os resultados dos testes
@@ -184,18 +260,26 @@ void generate_csv_report(const vector<TestResult>& results, const string& output
     }
     
     // Cabeçalho
-    csv << "Teste,Ficheiro,Tamanho_Bloco,Num_Coeficientes,Fator_Quantizacao,";
+    csv << "Teste,Ficheiro,Tamanho_Bloco,Num_Coeficientes,Fator_Quantizacao,Codificacao,Matriz,Transformada,";
     csv << "Duracao_s,Tamanho_Original_bytes,Tamanho_Comprimido_bytes,";
     csv << "Taxa_Compressao,Bitrate_kbps,SNR_dB,";
     csv << "Tempo_Codificacao_s,Tempo_Descodificacao_s" << endl;
     
     // Dados
     for (const auto& r : results) {
-        csv << r.test_name << ","
+        const TestOptions& o = r.options;
+        csv << o.name << ","
             << r.input_file << ","
-            << r.block_size << ","
-            << r.num_coeffs << ","
-            << r.quantization_factor << ","
+            << o.block_size << ","
+            << o.num_coeffs << ","
+            << o.quant_factor << ","
+            << (o.coding == DCTCoding::RICE ? "rice" : o.coding == DCTCoding::HUFFMAN ? "huffman" : "raw") << (o.eob ? "+eob" : "") << (o.mid_side ? "+ms" : "");
+        if (o.target_kbps > 0.0) csv << "+" << static_cast<int>(o.target_kbps) << "kbps";
+        if (o.target_snr > 0.0) csv << "+" << static_cast<int>(o.target_snr) << "dB";
+        csv << ","
+            << (o.matrix == DCTMatrix::PERCEPTUAL ? "perceptual" : o.matrix == DCTMatrix::CUSTOM ? "ficheiro" : "flat") << ","
+            << (o.transform == DCTTransform::MDCT_KBD ? "mdct-kbd" : o.transform == DCTTransform::MDCT_SINE ? "mdct" : "dct")
+            << (o.block_switching ? "+curtos" : "") << ","
             << fixed << setprecision(3)
             << r.duration << ","
             << r.original_size << ","
@@ -211,6 +295,113 @@ void generate_csv_report(const vector<TestResult>& results, const string& output
     cout << "\n\nRelatório CSV gerado: " << output_file << endl;
 }
 
+/**
+ * @brief Mostra o conjunto de instruções escolhido para os kernels da DCT e o
+ *        ganho face aos kernels escalares (transformada matricial, blocos de 256)
+ */
+void report_kernel_isa() {
+    const int block_size = 256;
+    const int iterations = 2000;
+    
+    vector<short> block(block_size);
+    for (int n = 0; n < block_size; n++) {
+        block[n] = static_cast<short>(8000.0 * sin(0.05 * n) + 2000.0 * cos(0.9 * n));
+    }
+    
+    auto measure = [&]() {
+        DCTCodec codec(block_size, block_size, 1);
+        codec.set_engine(DCTEngine::MATRIX);
+        long checksum = 0;
+        auto start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            checksum += codec.apply_idct(codec.apply_dct(block))[i % block_size];
+        }
+        double elapsed = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        return (checksum == 42) ? elapsed + 1e-12 : elapsed;
+    };
+    
+    KernelISA best = detect_kernel_isa();
+    set_kernel_isa(KernelISA::SCALAR);
+    double scalar_time = measure();
+    set_kernel_isa(best);
+    double simd_time = measure();
+    
+    cout << "Kernels DCT: " << dct_kernels().name
+         << " (speedup " << fixed << setprecision(2) << scalar_time / simd_time
+         << "x face ao escalar)" << endl << endl;
+}
+
+/**
+ * @brief Testes feitos a cada ficheiro (mono ou estéreo)
+ */
+vector<TestOptions> codec_tests() {
+    return {
+        // Testes baseados na tabela fornecida (T1 removido devido a problema de precisão numérica)
+        { .name = "T2", .block_size = 512, .num_coeffs = 256, .quant_factor = 2 },
+        { .name = "T3", .block_size = 512, .num_coeffs = 128, .quant_factor = 5 },
+        { .name = "T4", .block_size = 1024, .num_coeffs = 256, .quant_factor = 10 },
+        { .name = "T5", .block_size = 1024, .num_coeffs = 128, .quant_factor = 20 },
+        { .name = "T6", .block_size = 256, .num_coeffs = 128, .quant_factor = 5 },
+        { .name = "T7", .block_size = 256, .num_coeffs = 64, .quant_factor = 10 },
+        
+        // Mesmos parâmetros com Golomb-Rice: mesmo SNR, ficheiro mais pequeno
+        { .name = "T2R", .block_size = 512, .num_coeffs = 256, .quant_factor = 2, .coding = DCTCoding::RICE },
+        { .name = "T3R", .block_size = 512, .num_coeffs = 128, .quant_factor = 5, .coding = DCTCoding::RICE },
+        { .name = "T4R", .block_size = 1024, .num_coeffs = 256, .quant_factor = 10, .coding = DCTCoding::RICE },
+        { .name = "T5R", .block_size = 1024, .num_coeffs = 128, .quant_factor = 20, .coding = DCTCoding::RICE },
+        { .name = "T6R", .block_size = 256, .num_coeffs = 128, .quant_factor = 5, .coding = DCTCoding::RICE },
+        { .name = "T7R", .block_size = 256, .num_coeffs = 64, .quant_factor = 10, .coding = DCTCoding::RICE },
+        
+        // Todos os coeficientes com Q alto (cauda de zeros longa), com e sem EOB
+        { .name = "T8", .block_size = 256, .num_coeffs = 256, .quant_factor = 100 },
+        { .name = "T8E", .block_size = 256, .num_coeffs = 256, .quant_factor = 100, .eob = true },
+        { .name = "T8R", .block_size = 256, .num_coeffs = 256, .quant_factor = 100, .coding = DCTCoding::RICE },
+        { .name = "T8RE", .block_size = 256, .num_coeffs = 256, .quant_factor = 100, .coding = DCTCoding::RICE, .eob = true },
+        
+        // Huffman canónico por segmento
+        { .name = "T4H", .block_size = 1024, .num_coeffs = 256, .quant_factor = 10, .coding = DCTCoding::HUFFMAN },
+        { .name = "T7H", .block_size = 256, .num_coeffs = 64, .quant_factor = 10, .coding = DCTCoding::HUFFMAN },
+        { .name = "T8H", .block_size = 256, .num_coeffs = 256, .quant_factor = 100, .coding = DCTCoding::HUFFMAN },
+        { .name = "T8HE", .block_size = 256, .num_coeffs = 256, .quant_factor = 100, .coding = DCTCoding::HUFFMAN, .eob = true },
+        
+        // Controlo de débito: passo escolhido por segmento para um débito ou SNR alvo
+        { .name = "RB64", .block_size = 1024, .num_coeffs = 1024, .quant_factor = 10, .coding = DCTCoding::RICE, .eob = true,
+          .target_kbps = 64.0 },
+        { .name = "RS30", .block_size = 1024, .num_coeffs = 1024, .quant_factor = 10, .coding = DCTCoding::RICE, .eob = true,
+          .target_snr = 30.0 },
+        
+        // Matriz perceptual: passo maior nas altas frequências (Q fixo e ao mesmo débito de RB64)
+        { .name = "T8REP", .block_size = 256, .num_coeffs = 256, .quant_factor = 100, .coding = DCTCoding::RICE, .eob = true,
+          .matrix = DCTMatrix::PERCEPTUAL },
+        { .name = "RB64P", .block_size = 1024, .num_coeffs = 1024, .quant_factor = 10, .coding = DCTCoding::RICE, .eob = true,
+          .target_kbps = 64.0, .matrix = DCTMatrix::PERCEPTUAL },
+        
+        // MDCT (sem descontinuidades nas fronteiras dos blocos) com os parâmetros de T4R e RB64
+        { .name = "M4R", .block_size = 1024, .num_coeffs = 256, .quant_factor = 10, .coding = DCTCoding::RICE,
+          .transform = DCTTransform::MDCT_SINE },
+        { .name = "MB64", .block_size = 1024, .num_coeffs = 1024, .quant_factor = 10, .coding = DCTCoding::RICE, .eob = true,
+          .target_kbps = 64.0, .transform = DCTTransform::MDCT_SINE },
+        { .name = "MB64K", .block_size = 1024, .num_coeffs = 1024, .quant_factor = 10, .coding = DCTCoding::RICE, .eob = true,
+          .target_kbps = 64.0, .transform = DCTTransform::MDCT_KBD },
+        
+        // Comutação de blocos (blocos curtos nos transientes) com os parâmetros de T4R e RB64
+        { .name = "A4R", .block_size = 1024, .num_coeffs = 256, .quant_factor = 10, .coding = DCTCoding::RICE,
+          .block_switching = true },
+        { .name = "AB64", .block_size = 1024, .num_coeffs = 1024, .quant_factor = 10, .coding = DCTCoding::RICE, .eob = true,
+          .target_kbps = 64.0, .block_switching = true },
+    };
+}
+
+/**
+ * @brief Testes feitos só a ficheiros estéreo: canais L/R independentes e MID/SIDE
+ */
+vector<TestOptions> stereo_tests() {
+    return {
+        { .name = "S4R", .block_size = 1024, .num_coeffs = 256, .quant_factor = 10, .coding = DCTCoding::RICE },
+        { .name = "S4RM", .block_size = 1024, .num_coeffs = 256, .quant_factor = 10, .coding = DCTCoding::RICE, .mid_side = true },
+    };
+}
+
 /**
  * @brief Programa principal
  */
@@ -219,7 +410,10 @@ int main(int argc, char* argv[]) {
     cout << "   DCT Audio Codec - Programa de Teste" << endl;
     cout << "===============================================\n" << endl;
     
+    report_kernel_isa();
+    
     vector<TestResult> all_results;
+    bool seek_ok = true;    // Acesso aleatório igual à descodificação completa
     
     // Verificar se foi fornecido um ficheiro específico
     if (argc > 1) {
@@ -228,14 +422,19 @@ int main(int argc, char* argv[]) {
         
         cout << "Testando ficheiro: " << input_file << endl;
         
-        // Executar testes com diferentes parâmetros (T2-T7)
-        // T1 removido devido a problema de precisão numérica
-        all_results.push_back(run_test(input_file, "T2", 512, 256, 2));
-        all_results.push_back(run_test(input_file, "T3", 512, 128, 5));
-        all_results.push_back(run_test(input_file, "T4", 1024, 256, 10));
-        all_results.push_back(run_test(input_file, "T5", 1024, 128, 20));
-        all_results.push_back(run_test(input_file, "T6", 256, 128, 5));
-        all_results.push_back(run_test(input_file, "T7", 256, 64, 10));
+        for (const auto& options : codec_tests()) {
+            all_results.push_back(run_test(input_file, options));
+        }
+        
+        // Estéreo: canais L/R independentes e MID/SIDE
+        WAVReader reader;
+        if (reader.open(input_file) && reader.header().num_channels == 2) {
+            for (const auto& options : stereo_tests()) {
+                all_results.push_back(run_test(input_file, options));
+            }
+        }
+        
+        seek_ok = check_seek(input_file) && seek_ok;
         
     } else {
         // Modo: testar todos os ficheiros na pasta audio_files/mono
@@ -268,13 +467,25 @@ int main(int argc, char* argv[]) {
         for (const auto& wav_file : wav_files) {
             cout << "\n\n*** Ficheiro: " << wav_file << " ***\n" << endl;
             
-            // Testes baseados na tabela fornecida
-            all_results.push_back(run_test(wav_file, "T2", 512, 256, 2));
-            all_results.push_back(run_test(wav_file, "T3", 512, 128, 5));
-            all_results.push_back(run_test(wav_file, "T4", 1024, 256, 10));
-            all_results.push_back(run_test(wav_file, "T5", 1024, 128, 20));
-            all_results.push_back(run_test(wav_file, "T6", 256, 128, 5));
-            all_results.push_back(run_test(wav_file, "T7", 256, 64, 10));
+            for (const auto& options : codec_tests()) {
+                all_results.push_back(run_test(wav_file, options));
+            }
+            
+            seek_ok = check_seek(wav_file) && seek_ok;
+        }
+        
+        // Ficheiros estéreo: canais L/R independentes e MID/SIDE
+        string stereo_dir = "../../../audio_files/stereo";
+        if (fs::exists(stereo_dir)) {
+            for (const auto& entry : fs::directory_iterator(stereo_dir)) {
+                if (entry.path().extension() != ".wav") continue;
+                string wav_file = entry.path().string();
+                cout << "\n\n*** Ficheiro: " << wav_file << " ***\n" << endl;
+                
+                for (const auto& options : stereo_tests()) {
+                    all_results.push_back(run_test(wav_file, options));
+                }
+            }
         }
     }
     
@@ -285,5 +496,9 @@ int main(int argc, char* argv[]) {
     cout << "   Testes concluídos!" << endl;
     cout << "===============================================" << endl;
     
+    if (!seek_ok) {
+        cerr << "Erro: acesso aleatório difere da descodificação completa" << endl;
+        return 1;
+    }
     return 0;
 }
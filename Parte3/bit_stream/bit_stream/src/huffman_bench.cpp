@@ -0,0 +1,112 @@
+//-------------------------------------------------------------------------------------------
+//
+// Huffman Benchmark - Débito de codificação/descodificação do Huffman canónico
+//
+//-------------------------------------------------------------------------------------------
+
+#include "huffman.h"
+#include "bit_stream.h"
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+
+using namespace std;
+
+/**
+ * @brief Codifica e descodifica símbolos com distribuição geométrica, medindo o débito
+ * @param alphabet Tamanho do alfabeto
+ * @param ratio Razão da distribuição (p(s+1)/p(s)); perto de 1 = quase uniforme
+ * @param num_symbols Número de símbolos a processar
+ * @param tmp_file Ficheiro temporário usado pelo teste
+ * @return true se os símbolos descodificados coincidirem com os originais
+ */
+bool bench_alphabet(uint32_t alphabet, double ratio, size_t num_symbols, const string& tmp_file) {
+    // Símbolos pseudo-aleatórios (xorshift + inversão da CDF geométrica)
+    vector<uint32_t> symbols(num_symbols);
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    double log_ratio = log(ratio);
+    for (auto& s : symbols) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        double u = (static_cast<double>(x >> 11) + 0.5) / 9007199254740992.0;
+        double v = floor(log(u) / log_ratio);
+        s = static_cast<uint32_t>(min(v, static_cast<double>(alphabet - 1)));
+    }
+
+    vector<uint64_t> histogram(alphabet, 0);
+    for (uint32_t s : symbols) histogram[s]++;
+
+    // Construção do código + codificação
+    auto start_encode = chrono::high_resolution_clock::now();
+    HuffmanCode code = HuffmanCode::from_histogram(histogram);
+    {
+        fstream ofs(tmp_file, ios::out | ios::binary);
+        BitStream obs(ofs, STREAM_WRITE);
+        code.write_table(obs);
+        for (uint32_t s : symbols) {
+            code.encode(obs, s);
+        }
+        obs.close();
+    }
+    auto end_encode = chrono::high_resolution_clock::now();
+
+    // Leitura da tabela + descodificação
+    bool ok = true;
+    auto start_decode = chrono::high_resolution_clock::now();
+    {
+        BitStream ibs(tmp_file);
+        HuffmanCode read_code = HuffmanCode::read_table(ibs);
+        ok = read_code.is_valid();
+        for (uint32_t s : symbols) {
+            if (read_code.decode(ibs) != s) {
+                ok = false;
+            }
+        }
+        ibs.close();
+    }
+    auto end_decode = chrono::high_resolution_clock::now();
+
+    double encode_time = chrono::duration<double>(end_encode - start_encode).count();
+    double decode_time = chrono::duration<double>(end_decode - start_decode).count();
+    double bits_per_symbol = static_cast<double>(code.encoded_bits(histogram)) / num_symbols;
+
+    // MB/s medidos sobre os símbolos como amostras de 16 bits
+    double megabytes = 2.0 * num_symbols / 1e6;
+
+    cout << setw(9) << alphabet
+         << setw(8) << setprecision(4) << ratio
+         << setw(12) << setprecision(2) << bits_per_symbol
+         << setw(14) << setprecision(1) << megabytes / encode_time
+         << setw(14) << megabytes / decode_time
+         << setw(8) << (ok ? "OK" : "ERRO") << endl;
+
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    // Número de símbolos por teste (default: 16M)
+    size_t num_symbols = (argc > 1) ? strtoull(argv[1], nullptr, 10) : (size_t(1) << 24);
+    string tmp_file = "huffman_bench.tmp";
+
+    cout << "Huffman Benchmark" << endl;
+    cout << "=================" << endl;
+    cout << fixed;
+    cout << setw(9) << "Alfabeto" << setw(8) << "Razão" << setw(12) << "Bits/símb"
+         << setw(14) << "Cod. MB/s" << setw(14) << "Desc. MB/s"
+         << setw(8) << "Check" << endl;
+
+    bool ok = true;
+    ok = bench_alphabet(256, 0.5, num_symbols, tmp_file) && ok;        // Muito concentrada
+    ok = bench_alphabet(1024, 0.9, num_symbols, tmp_file) && ok;       // Coeficientes DCT
+    ok = bench_alphabet(256, 0.99, num_symbols, tmp_file) && ok;       // Quase uniforme
+    ok = bench_alphabet(65536, 0.9995, num_symbols, tmp_file) && ok;   // Amostras de 16 bits
+
+    remove(tmp_file.c_str());
+    return ok ? 0 : 1;
+}
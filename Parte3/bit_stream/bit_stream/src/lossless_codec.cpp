@@ -0,0 +1,276 @@
+//-------------------------------------------------------------------------------------------
+//
+// Lossless Audio Codec - Implementação
+//
+//-------------------------------------------------------------------------------------------
+
+#include "lossless_codec.h"
+#include "dct_codec.h"
+#include "bit_stream.h"
+#include "rice.h"
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+const int LOSSLESS_BATCH_BLOCKS = 64;   // Blocos lidos/escritos do WAV de cada vez
+
+//-------------------------------------------------------------------------------------------
+// Construtor
+//-------------------------------------------------------------------------------------------
+LosslessCodec::LosslessCodec(int block_size, int max_order)
+    : m_block_size(block_size), m_max_order(max(0, min(max_order, LOSSLESS_MAX_ORDER))) {
+}
+
+//-------------------------------------------------------------------------------------------
+// Preditores fixos: o de ordem p é a diferença de ordem p do sinal
+//-------------------------------------------------------------------------------------------
+void LosslessCodec::compute_residuals(const int* x, int count, int order, int* residuals) {
+    const int* s = x + LOSSLESS_MAX_ORDER;
+    switch (order) {
+        case 0:
+            for (int n = 0; n < count; n++) residuals[n] = s[n];
+            break;
+        case 1:
+            for (int n = 0; n < count; n++) residuals[n] = s[n] - s[n - 1];
+            break;
+        case 2:
+            for (int n = 0; n < count; n++) residuals[n] = s[n] - 2 * s[n - 1] + s[n - 2];
+            break;
+        case 3:
+            for (int n = 0; n < count; n++) residuals[n] = s[n] - 3 * s[n - 1] + 3 * s[n - 2] - s[n - 3];
+            break;
+        default:
+            for (int n = 0; n < count; n++) {
+                residuals[n] = s[n] - 4 * s[n - 1] + 6 * s[n - 2] - 4 * s[n - 3] + s[n - 4];
+            }
+            break;
+    }
+}
+
+static int predict(const int* s, int order) {
+    switch (order) {
+        case 0: return 0;
+        case 1: return s[-1];
+        case 2: return 2 * s[-1] - s[-2];
+        case 3: return 3 * s[-1] - 3 * s[-2] + s[-3];
+        default: return 4 * s[-1] - 6 * s[-2] + 4 * s[-3] - s[-4];
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// Parâmetro de Rice: custo exato (com escape) em torno da estimativa pela média
+//-------------------------------------------------------------------------------------------
+static uint64_t rice_cost(const vector<uint32_t>& mapped, int count, int k) {
+    uint64_t bits = 0;
+    for (int n = 0; n < count; n++) {
+        uint32_t q = mapped[n] >> k;
+        bits += (q >= static_cast<uint32_t>(RICE_ESCAPE_Q)) ? RICE_ESCAPE_Q + 1 + 32 : q + 1 + k;
+    }
+    return bits;
+}
+
+static int best_rice_k(const vector<uint32_t>& mapped, int count) {
+    uint64_t sum = 0;
+    for (int n = 0; n < count; n++) sum += mapped[n];
+
+    int k0 = 0;
+    while (k0 < RICE_MAX_K && (static_cast<uint64_t>(count) << (k0 + 1)) <= sum) k0++;
+
+    int best_k = k0;
+    uint64_t best_bits = rice_cost(mapped, count, k0);
+    for (int k : { k0 - 1, k0 + 1 }) {
+        if (k < 0 || k > RICE_MAX_K) continue;
+        uint64_t bits = rice_cost(mapped, count, k);
+        if (bits < best_bits) {
+            best_bits = bits;
+            best_k = k;
+        }
+    }
+    return best_k;
+}
+
+//-------------------------------------------------------------------------------------------
+// Codificação de um bloco
+//-------------------------------------------------------------------------------------------
+void LosslessCodec::encode_block(const int* x, int count, BitStream& bs) {
+    // Ordem com menor soma dos valores absolutos dos resíduos
+    vector<int> residuals(count);
+    int best_order = 0;
+    uint64_t best_sum = UINT64_MAX;
+    for (int order = 0; order <= m_max_order; order++) {
+        compute_residuals(x, count, order, residuals.data());
+        uint64_t sum = 0;
+        for (int n = 0; n < count; n++) sum += static_cast<uint64_t>(abs(residuals[n]));
+        if (sum < best_sum) {
+            best_sum = sum;
+            best_order = order;
+        }
+    }
+
+    compute_residuals(x, count, best_order, residuals.data());
+    vector<uint32_t> mapped(count);
+    for (int n = 0; n < count; n++) mapped[n] = zigzag_encode(residuals[n]);
+    int k = best_rice_k(mapped, count);
+
+    bs.write_n_bits(best_order, 3);
+    bs.write_n_bits(k, 5);
+    for (int n = 0; n < count; n++) {
+        rice_write(bs, mapped[n], k);
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// Descodificação de um bloco
+//-------------------------------------------------------------------------------------------
+void LosslessCodec::decode_block(int* x, int count, BitStream& bs) {
+    int order = min(static_cast<int>(bs.read_n_bits(3)), LOSSLESS_MAX_ORDER);
+    int k = static_cast<int>(bs.read_n_bits(5));
+
+    int* s = x + LOSSLESS_MAX_ORDER;
+    for (int n = 0; n < count; n++) {
+        s[n] = predict(s + n, order) + zigzag_decode(rice_read(bs, k));
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// ENCODER - Codifica ficheiro WAV para .lsl
+//-------------------------------------------------------------------------------------------
+bool LosslessCodec::encode(const string& input_file, const string& output_file) {
+    WAVReader reader;
+    if (!reader.open(input_file)) {
+        return false;
+    }
+    const WAVHeader& header = reader.header();
+
+    cout << "Codificando: " << input_file << endl;
+    cout << "  Sample rate: " << header.sample_rate << " Hz" << endl;
+    cout << "  Amostras: " << reader.num_samples() << endl;
+    cout << "  Tamanho do bloco: " << m_block_size << endl;
+    cout << "  Ordem máxima do preditor: " << m_max_order << endl;
+
+    if (header.num_channels != 1) {
+        cerr << "Erro: apenas suportado áudio mono (1 canal)" << endl;
+        return false;
+    }
+
+    // Converter outros formatos para 16 bits deixaria de ser sem perdas
+    if (reader.format() != WAVSampleFormat::PCM_16 || reader.num_samples() > UINT32_MAX) {
+        cerr << "Erro: apenas suportado PCM 16 bits (até 2^32 amostras)" << endl;
+        return false;
+    }
+
+    if (m_block_size <= 0 || m_block_size > 0xFFFF) {
+        cerr << "Erro: tamanho do bloco deve estar entre 1 e 65535" << endl;
+        return false;
+    }
+
+    fstream output(output_file, ios::out | ios::binary);
+    if (!output.is_open()) {
+        cerr << "Erro: não foi possível criar " << output_file << endl;
+        return false;
+    }
+
+    BitStream bs(output, STREAM_WRITE);
+
+    // Cabeçalho do formato .lsl
+    bs.write_n_bits(m_block_size, 16);
+    bs.write_n_bits(header.sample_rate, 32);
+    bs.write_n_bits(reader.num_samples(), 32);
+
+    // As amostras são lidas em lotes; x guarda o histórico do preditor seguido do bloco
+    vector<short> samples(static_cast<size_t>(LOSSLESS_BATCH_BLOCKS) * m_block_size);
+    vector<int> x(LOSSLESS_MAX_ORDER + m_block_size, 0);
+
+    while (true) {
+        int total = static_cast<int>(reader.read(samples.data(), samples.size()));
+        if (total == 0) break;
+
+        for (int start = 0; start < total; start += m_block_size) {
+            int count = min(m_block_size, total - start);
+            copy(samples.begin() + start, samples.begin() + start + count, x.begin() + LOSSLESS_MAX_ORDER);
+
+            encode_block(x.data(), count, bs);
+
+            // Últimas amostras passam a histórico do bloco seguinte
+            copy(x.begin() + count, x.begin() + count + LOSSLESS_MAX_ORDER, x.begin());
+        }
+    }
+
+    uint64_t total_bytes = bs.tell();
+    bs.close();
+    output.close();
+
+    cout << "  Bytes escritos: " << total_bytes << " ("
+         << 8.0 * total_bytes / max<uint32_t>(reader.num_samples(), 1)
+         << " bits/amostra)" << endl;
+    cout << "Ficheiro codificado: " << output_file << endl;
+
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+// DECODER - Descodifica ficheiro .lsl para WAV
+//-------------------------------------------------------------------------------------------
+bool LosslessCodec::decode(const string& input_file, const string& output_file) {
+    BitStream bs(input_file);
+    if (!bs.is_open()) {
+        cerr << "Erro: não foi possível abrir " << input_file << endl;
+        return false;
+    }
+
+    int block_size = static_cast<int>(bs.read_n_bits(16));
+    int sample_rate = static_cast<int>(bs.read_n_bits(32));
+    uint32_t total_samples = static_cast<uint32_t>(bs.read_n_bits(32));
+
+    if (block_size <= 0) {
+        cerr << "Erro: cabeçalho .lsl inválido" << endl;
+        return false;
+    }
+
+    cout << "Descodificando: " << input_file << endl;
+    cout << "  Sample rate: " << sample_rate << " Hz" << endl;
+    cout << "  Amostras: " << total_samples << endl;
+    cout << "  Tamanho do bloco: " << block_size << endl;
+
+    m_block_size = block_size;
+
+    WAVWriter writer;
+    if (!writer.open(output_file, sample_rate)) {
+        return false;
+    }
+
+    vector<short> samples(static_cast<size_t>(LOSSLESS_BATCH_BLOCKS) * m_block_size);
+    vector<int> x(LOSSLESS_MAX_ORDER + m_block_size, 0);
+
+    uint32_t done = 0;
+    while (done < total_samples) {
+        uint32_t batch = min<uint32_t>(samples.size(), total_samples - done);
+
+        for (uint32_t start = 0; start < batch; start += m_block_size) {
+            int count = static_cast<int>(min<uint32_t>(m_block_size, batch - start));
+            decode_block(x.data(), count, bs);
+
+            for (int n = 0; n < count; n++) {
+                samples[start + n] = static_cast<short>(x[LOSSLESS_MAX_ORDER + n]);
+            }
+            copy(x.begin() + count, x.begin() + count + LOSSLESS_MAX_ORDER, x.begin());
+        }
+
+        writer.write(samples.data(), batch);
+        done += batch;
+    }
+
+    bs.close();
+
+    if (!writer.close()) {
+        cerr << "Erro: falha ao escrever " << output_file << endl;
+        return false;
+    }
+
+    cout << "Ficheiro descodificado: " << output_file << endl;
+
+    return true;
+}
@@ -0,0 +1,85 @@
+//-------------------------------------------------------------------------------------------
+//
+// Lossless Audio Codec - Header File
+// Codec sem perdas com predição linear fixa por bloco e resíduos em Golomb-Rice
+//
+//-------------------------------------------------------------------------------------------
+
+#ifndef LOSSLESS_CODEC_H
+#define LOSSLESS_CODEC_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+class BitStream;
+
+const int LOSSLESS_MAX_ORDER = 4;       // Maior ordem dos preditores fixos
+
+/**
+ * @brief Codec sem perdas (ficheiros .lsl) ao estilo do Shorten/FLAC
+ *
+ * Cada bloco escolhe o preditor fixo de ordem 0 a max_order que dá menor soma
+ * dos resíduos, em que o preditor de ordem p é o polinómio de grau p-1 que passa
+ * pelas p amostras anteriores (ordem 2: 2·x[n-1] - x[n-2], ...). As amostras
+ * anteriores a um bloco vêm do bloco anterior, pelo que não há amostras de
+ * aquecimento. Os resíduos são escritos em Golomb-Rice com o parâmetro k de
+ * menor custo para o bloco.
+ *
+ * Formato:
+ *   cabeçalho: block_size (16 bits), sample_rate (32), total_samples (32)
+ *   por bloco: ordem (3 bits), k (5 bits), resíduos
+ */
+class LosslessCodec {
+private:
+    int m_block_size;
+    int m_max_order;
+
+    /**
+     * @brief Resíduos de um bloco com o preditor de uma dada ordem
+     * @param x Amostras do bloco, precedidas de LOSSLESS_MAX_ORDER amostras de histórico
+     * @param count Amostras do bloco
+     * @param order Ordem do preditor
+     * @param residuals Destino (count valores)
+     */
+    static void compute_residuals(const int* x, int count, int order, int* residuals);
+
+    /**
+     * @brief Codifica um bloco (escolha do preditor e de k + resíduos)
+     */
+    void encode_block(const int* x, int count, BitStream& bs);
+
+    /**
+     * @brief Descodifica um bloco para x (precedido do histórico, como em compute_residuals)
+     */
+    void decode_block(int* x, int count, BitStream& bs);
+
+public:
+    /**
+     * @brief Construtor
+     * @param block_size Amostras por bloco
+     * @param max_order Maior ordem de preditor a experimentar (0 a LOSSLESS_MAX_ORDER)
+     */
+    LosslessCodec(int block_size, int max_order = LOSSLESS_MAX_ORDER);
+
+    /**
+     * @brief Codifica um ficheiro WAV mono 16-bit
+     * @param input_file Nome do ficheiro WAV de entrada
+     * @param output_file Nome do ficheiro .lsl de saída
+     * @return true se sucesso, false caso contrário
+     */
+    bool encode(const std::string& input_file, const std::string& output_file);
+
+    /**
+     * @brief Descodifica um ficheiro .lsl (os parâmetros vêm do cabeçalho)
+     * @param input_file Nome do ficheiro .lsl de entrada
+     * @param output_file Nome do ficheiro WAV de saída
+     * @return true se sucesso, false caso contrário
+     */
+    bool decode(const std::string& input_file, const std::string& output_file);
+
+    int get_block_size() const { return m_block_size; }
+    int get_max_order() const { return m_max_order; }
+};
+
+#endif
@@ -0,0 +1,33 @@
+//-------------------------------------------------------------------------------------------
+//
+// Lossless Decoder - Programa para descodificar ficheiros .lsl
+//
+//-------------------------------------------------------------------------------------------
+
+#include "lossless_codec.h"
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    cout << "Lossless Audio Decoder" << endl;
+    cout << "======================" << endl;
+    
+    if (argc < 3) {
+        cout << "\nUso: " << argv[0] << " <input.lsl> <output.wav>" << endl;
+        cout << "\nExemplo:" << endl;
+        cout << "  " << argv[0] << " audio.lsl audio_decoded.wav" << endl;
+        return 1;
+    }
+    
+    // Os parâmetros são lidos do ficheiro .lsl
+    LosslessCodec codec(4096);
+    if (!codec.decode(argv[1], argv[2])) {
+        cerr << "\nErro durante a descodificação!" << endl;
+        return 1;
+    }
+    
+    cout << "\nDescodificação concluída com sucesso!" << endl;
+    return 0;
+}
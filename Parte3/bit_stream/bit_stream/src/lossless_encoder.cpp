@@ -0,0 +1,51 @@
+//-------------------------------------------------------------------------------------------
+//
+// Lossless Encoder - Programa para codificar ficheiros WAV sem perdas
+//
+//-------------------------------------------------------------------------------------------
+
+#include "lossless_codec.h"
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    cout << "Lossless Audio Encoder" << endl;
+    cout << "======================" << endl;
+    
+    // Verificar argumentos
+    if (argc < 3) {
+        cout << "\nUso: " << argv[0] << " <input.wav> <output.lsl> [block_size] [max_order]" << endl;
+        cout << "\nParâmetros opcionais:" << endl;
+        cout << "  block_size     - Tamanho do bloco (default: 4096)" << endl;
+        cout << "  max_order      - Maior ordem do preditor fixo, 0 a " << LOSSLESS_MAX_ORDER
+             << " (default: " << LOSSLESS_MAX_ORDER << ")" << endl;
+        cout << "\nExemplos:" << endl;
+        cout << "  " << argv[0] << " audio.wav audio.lsl" << endl;
+        cout << "  " << argv[0] << " audio.wav audio.lsl 1152 2" << endl;
+        return 1;
+    }
+    
+    string input_file = argv[1];
+    string output_file = argv[2];
+    
+    int block_size = (argc > 3) ? atoi(argv[3]) : 4096;
+    int max_order = (argc > 4) ? atoi(argv[4]) : LOSSLESS_MAX_ORDER;
+    
+    if (block_size <= 0 || block_size > 0xFFFF || max_order < 0 || max_order > LOSSLESS_MAX_ORDER) {
+        cerr << "Erro: block_size deve estar entre 1 e 65535 e max_order entre 0 e "
+             << LOSSLESS_MAX_ORDER << endl;
+        return 1;
+    }
+    
+    LosslessCodec codec(block_size, max_order);
+    if (!codec.encode(input_file, output_file)) {
+        cerr << "\nErro durante a codificação!" << endl;
+        return 1;
+    }
+    
+    cout << "\nCodificação concluída com sucesso!" << endl;
+    return 0;
+}
@@ -0,0 +1,110 @@
+//-------------------------------------------------------------------------------------------
+//
+// Programa de Teste do Lossless Codec
+// Verifica que a descodificação reproduz exatamente as amostras originais e mede
+// a taxa de compressão e a velocidade face ao tempo real
+//
+//-------------------------------------------------------------------------------------------
+
+#include "lossless_codec.h"
+#include "dct_codec.h"
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <filesystem>
+#include <chrono>
+#include <cstdio>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+/**
+ * @brief Codifica e descodifica um ficheiro e compara as amostras
+ * @param input_wav Ficheiro de entrada WAV
+ * @param block_size Tamanho do bloco
+ * @param max_order Maior ordem do preditor
+ * @return true se a descodificação for exata
+ */
+bool run_test(const string& input_wav, int block_size, int max_order) {
+    string encoded_file = "lossless_test.lsl";
+    string decoded_file = "lossless_test_decoded.wav";
+    
+    LosslessCodec codec(block_size, max_order);
+    
+    // Saída do codec suprimida: só interessa a linha de resultados
+    streambuf* cout_buf = cout.rdbuf(nullptr);
+    auto start_encode = chrono::high_resolution_clock::now();
+    bool ok = codec.encode(input_wav, encoded_file);
+    auto end_encode = chrono::high_resolution_clock::now();
+    ok = ok && codec.decode(encoded_file, decoded_file);
+    auto end_decode = chrono::high_resolution_clock::now();
+    cout.rdbuf(cout_buf);
+    
+    WAVHeader original_header, decoded_header;
+    vector<short> original, decoded;
+    ok = ok && read_wav_file(input_wav, original_header, original)
+            && read_wav_file(decoded_file, decoded_header, decoded)
+            && original == decoded
+            && original_header.sample_rate == decoded_header.sample_rate;
+    
+    double duration = static_cast<double>(original.size()) / max(original_header.sample_rate, 1);
+    double encoding_time = chrono::duration<double>(end_encode - start_encode).count();
+    double decoding_time = chrono::duration<double>(end_decode - end_encode).count();
+    double original_size = 2.0 * original.size();
+    double compressed_size = ok ? static_cast<double>(fs::file_size(encoded_file)) : 0.0;
+    
+    cout << setw(24) << fs::path(input_wav).filename().string()
+         << setw(8) << block_size
+         << setw(7) << max_order
+         << fixed << setprecision(3)
+         << setw(10) << (compressed_size > 0 ? original_size / compressed_size : 0.0)
+         << setw(10) << setprecision(2) << (original.empty() ? 0.0 : 8.0 * compressed_size / original.size())
+         << setw(10) << setprecision(0) << duration / encoding_time << "x"
+         << setw(10) << duration / decoding_time << "x"
+         << setw(8) << (ok ? "OK" : "ERRO") << endl;
+    
+    remove(encoded_file.c_str());
+    remove(decoded_file.c_str());
+    return ok;
+}
+
+/**
+ * @brief Programa principal
+ */
+int main(int argc, char* argv[]) {
+    cout << "===============================================" << endl;
+    cout << "   Lossless Audio Codec - Programa de Teste" << endl;
+    cout << "===============================================\n" << endl;
+    
+    vector<string> wav_files;
+    if (argc > 1) {
+        wav_files.push_back(argv[1]);
+    } else {
+        string audio_dir = "../../../audio_files/mono";
+        if (!fs::exists(audio_dir)) {
+            cerr << "Erro: pasta audio_files/mono não encontrada!" << endl;
+            cerr << "Uso: " << argv[0] << " [ficheiro.wav]" << endl;
+            return 1;
+        }
+        for (const auto& entry : fs::directory_iterator(audio_dir)) {
+            if (entry.path().extension() == ".wav") {
+                wav_files.push_back(entry.path().string());
+            }
+        }
+    }
+    
+    cout << setw(24) << "Ficheiro" << setw(8) << "Bloco" << setw(7) << "Ordem"
+         << setw(10) << "Taxa" << setw(10) << "Bits/am."
+         << setw(11) << "Cod." << setw(11) << "Desc." << setw(8) << "Check" << endl;
+    
+    bool ok = true;
+    for (const auto& wav_file : wav_files) {
+        ok = run_test(wav_file, 4096, LOSSLESS_MAX_ORDER) && ok;
+        ok = run_test(wav_file, 1152, 2) && ok;
+        ok = run_test(wav_file, 4096, 0) && ok;
+        ok = run_test(wav_file, 1, LOSSLESS_MAX_ORDER) && ok;     // Blocos mínimos
+    }
+    
+    cout << "\n" << (ok ? "Todas as descodificações são exatas." : "ERRO: descodificação diferente do original!") << endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,140 @@
+//-------------------------------------------------------------------------------------------
+//
+// Golomb-Rice adaptativo
+//
+// Cada valor inteiro é mapeado para natural (zigzag: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...)
+// e escrito como código de Rice com parâmetro k: q = m >> k em unário (q zeros seguidos
+// de um 1) e depois os k bits menos significativos de m. O k de cada contexto é
+// estimado como no JPEG-LS a partir da soma A das magnitudes e do número N de valores
+// vistos, que são divididos por 2 a cada RICE_RESET valores para seguir o sinal.
+//
+// Writer/Reader podem ser BitStream, BitBuffer ou qualquer classe com
+// write_bit/write_n_bits ou read_bit/read_n_bits.
+//
+//-------------------------------------------------------------------------------------------
+
+#ifndef RICE_H
+#define RICE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+const int RICE_RESET = 64;          // Valores por contexto até dividir A e N por 2
+const int RICE_ESCAPE_Q = 24;       // Quociente a partir do qual o valor vai em 32 bits
+const int RICE_MAX_K = 24;
+
+/**
+ * @brief Mapeia um inteiro com sinal para natural (0, -1, 1, -2, 2, ...)
+ */
+inline uint32_t zigzag_encode(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+inline int32_t zigzag_decode(uint32_t m) {
+    return static_cast<int32_t>(m >> 1) ^ -static_cast<int32_t>(m & 1);
+}
+
+/**
+ * @brief Escreve m com parâmetro k (com escape para quocientes grandes)
+ */
+template <typename Writer>
+void rice_write(Writer& out, uint32_t m, int k) {
+    uint32_t q = m >> k;
+    if (q >= static_cast<uint32_t>(RICE_ESCAPE_Q)) {
+        out.write_n_bits(1, RICE_ESCAPE_Q + 1);
+        out.write_n_bits(m, 32);
+        return;
+    }
+    out.write_n_bits(1, q + 1);
+    out.write_n_bits(m, k);
+}
+
+template <typename Reader>
+uint32_t rice_read(Reader& in, int k) {
+    uint32_t q = 0;
+    while (in.read_bit() == 0) {
+        q++;
+    }
+    if (q >= static_cast<uint32_t>(RICE_ESCAPE_Q)) {
+        return static_cast<uint32_t>(in.read_n_bits(32));
+    }
+    return (q << k) | static_cast<uint32_t>(k > 0 ? in.read_n_bits(k) : 0);
+}
+
+/**
+ * @brief Estatísticas de um contexto (estilo JPEG-LS)
+ */
+struct RiceState {
+    uint64_t A;     // Soma das magnitudes mapeadas
+    uint32_t N;     // Número de valores
+
+    RiceState() { reset(); }
+
+    void reset() {
+        A = 4;
+        N = 1;
+    }
+
+    // Menor k com N·2^k >= A
+    int k() const {
+        int k = 0;
+        while ((static_cast<uint64_t>(N) << k) < A && k < RICE_MAX_K) k++;
+        return k;
+    }
+
+    void update(uint32_t m) {
+        A += m;
+        if (++N == static_cast<uint32_t>(RICE_RESET)) {
+            A >>= 1;
+            N >>= 1;
+        }
+    }
+};
+
+/**
+ * @brief Conjunto de contextos com parâmetro de Rice adaptativo
+ *
+ * Codificador e descodificador têm de percorrer os mesmos contextos pela
+ * mesma ordem e fazer reset() nos mesmos pontos.
+ */
+class RiceContext {
+private:
+    std::vector<RiceState> m_states;
+
+public:
+    explicit RiceContext(size_t num_contexts) : m_states(num_contexts) {}
+
+    void reset() {
+        for (RiceState& state : m_states) state.reset();
+    }
+
+    // Valores com sinal (mapeados por zigzag)
+    template <typename Writer>
+    void write(Writer& out, size_t context, int32_t value) {
+        write_unsigned(out, context, zigzag_encode(value));
+    }
+
+    template <typename Reader>
+    int32_t read(Reader& in, size_t context) {
+        return zigzag_decode(read_unsigned(in, context));
+    }
+
+    // Valores naturais (contagens, comprimentos de corridas)
+    template <typename Writer>
+    void write_unsigned(Writer& out, size_t context, uint32_t m) {
+        RiceState& state = m_states[context];
+        rice_write(out, m, state.k());
+        state.update(m);
+    }
+
+    template <typename Reader>
+    uint32_t read_unsigned(Reader& in, size_t context) {
+        RiceState& state = m_states[context];
+        uint32_t m = rice_read(in, state.k());
+        state.update(m);
+        return m;
+    }
+};
+
+#endif
@@ -0,0 +1,136 @@
+//-------------------------------------------------------------------------------------------
+//
+// Thread Pool - Implementação
+//
+//-------------------------------------------------------------------------------------------
+
+#include "thread_pool.h"
+
+using namespace std;
+
+// Pool e fila da thread atual (nullptr nas threads fora de qualquer pool)
+static thread_local const ThreadPool* t_pool = nullptr;
+static thread_local size_t t_queue = 0;
+
+//-------------------------------------------------------------------------------------------
+// Construtor / Destrutor
+//-------------------------------------------------------------------------------------------
+ThreadPool::ThreadPool(int num_threads) : m_pending(0), m_stop(false) {
+    if (num_threads <= 0) {
+        num_threads = max(1u, thread::hardware_concurrency());
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+        m_queues.push_back(make_unique<TaskQueue>());
+    }
+    for (int i = 1; i < num_threads; i++) {
+        m_workers.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// Threads de trabalho
+//-------------------------------------------------------------------------------------------
+void ThreadPool::worker_loop(size_t index) {
+    t_pool = this;
+    t_queue = index;
+
+    while (true) {
+        if (run_one(nullptr)) continue;
+
+        unique_lock<mutex> lock(m_mutex);
+        m_cv.wait(lock, [this] { return m_stop || m_pending.load() > 0; });
+        if (m_stop && m_pending.load() == 0) return;
+    }
+}
+
+size_t ThreadPool::local_queue() const {
+    return (t_pool == this) ? t_queue : 0;
+}
+
+bool ThreadPool::run_one(const void* group) {
+    size_t own = local_queue();
+    function<void()> task;
+
+    // Primeiro a própria fila (pelo fim), depois as outras (pelo início)
+    size_t num_queues = (group == nullptr) ? m_queues.size() : 1;
+    for (size_t n = 0; n < num_queues && !task; n++) {
+        TaskQueue& queue = *m_queues[(own + n) % m_queues.size()];
+        lock_guard<mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+
+        if (n == 0) {
+            if (group != nullptr && queue.tasks.back().group != group) break;
+            task = move(queue.tasks.back().fn);
+            queue.tasks.pop_back();
+        } else {
+            task = move(queue.tasks.front().fn);
+            queue.tasks.pop_front();
+        }
+    }
+    if (!task) return false;
+
+    m_pending.fetch_sub(1);
+    task();
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+// parallel_for
+//-------------------------------------------------------------------------------------------
+void ThreadPool::parallel_for(size_t count, const function<void(size_t)>& fn) {
+    if (m_workers.empty() || count <= 1) {
+        for (size_t i = 0; i < count; i++) fn(i);
+        return;
+    }
+
+    atomic<size_t> remaining(count);
+    mutex done_mutex;
+    condition_variable done_cv;
+
+    {
+        // Ordem inversa: a thread que chama começa pela tarefa 0 e os ladrões
+        // levam as últimas
+        TaskQueue& queue = *m_queues[local_queue()];
+        lock_guard<mutex> lock(queue.mutex);
+        for (size_t i = count; i-- > 0; ) {
+            queue.tasks.push_back({ [&, i] {
+                fn(i);
+                // Decremento com o done_mutex: quem chama só sai depois de o obter,
+                // pelo que o mutex e a condição (locais) existem até aqui
+                lock_guard<mutex> done_lock(done_mutex);
+                if (remaining.fetch_sub(1) == 1) {
+                    done_cv.notify_all();
+                }
+            }, &remaining });
+        }
+    }
+    {
+        lock_guard<mutex> lock(m_mutex);
+        m_pending.fetch_add(count);
+    }
+    m_cv.notify_all();
+
+    // A thread que chama ajuda a esvaziar a sua fila e depois espera pelas restantes
+    while (remaining.load() > 0) {
+        if (run_one(&remaining)) continue;
+
+        unique_lock<mutex> done_lock(done_mutex);
+        done_cv.wait(done_lock, [&] { return remaining.load() == 0; });
+    }
+
+    // A última tarefa pode ainda ter o done_mutex (viu-se remaining a 0 sem esperar)
+    lock_guard<mutex> done_lock(done_mutex);
+}
@@ -0,0 +1,97 @@
+//-------------------------------------------------------------------------------------------
+//
+// Thread Pool - Conjunto fixo de threads para processar blocos em paralelo
+//
+//-------------------------------------------------------------------------------------------
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+
+/**
+ * @brief Pool de threads com roubo de tarefas (work stealing) e um parallel_for
+ *        bloqueante
+ *
+ * Um pool de N threads cria N-1 threads de trabalho: a thread que chama
+ * parallel_for também executa tarefas enquanto espera, pelo que com N = 1
+ * tudo corre sequencialmente na thread que chama.
+ *
+ * Cada thread do pool tem a sua fila; as threads fora do pool partilham mais uma.
+ * parallel_for põe as tarefas na fila da thread que chama, que as retira pelo fim
+ * (a última criada primeiro); uma thread sem trabalho rouba-as pelo início da fila
+ * de outra. Assim um parallel_for chamado dentro de uma tarefa (ex.: os segmentos
+ * de um ficheiro no dct_batch) fica na thread que o chamou enquanto as outras
+ * estiverem ocupadas e é repartido quando ficam livres. Enquanto espera, quem
+ * chama parallel_for só executa tarefas desse parallel_for, para não começar
+ * trabalho alheio (ex.: outro ficheiro) antes de acabar o seu.
+ */
+class ThreadPool {
+private:
+    struct Task {
+        std::function<void()> fn;
+        const void* group;          // parallel_for que criou a tarefa
+    };
+
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::thread> m_workers;
+    std::vector<std::unique_ptr<TaskQueue>> m_queues;   // 0: threads fora do pool
+    std::atomic<size_t> m_pending;                      // Tarefas em todas as filas
+    std::mutex m_mutex;                                 // Protege o sono das threads
+    std::condition_variable m_cv;
+    bool m_stop;
+
+    /**
+     * @brief Ciclo das threads de trabalho
+     */
+    void worker_loop(size_t index);
+
+    /**
+     * @brief Fila da thread atual
+     */
+    size_t local_queue() const;
+
+    /**
+     * @brief Retira e executa uma tarefa
+     * @param group nullptr: da própria fila ou roubada a outra; caso contrário só
+     *        uma tarefa deste grupo do fim da própria fila
+     * @return true se executou uma tarefa
+     */
+    bool run_one(const void* group);
+
+public:
+    /**
+     * @brief Cria o pool
+     * @param num_threads Número total de threads (0 = número de cores)
+     */
+    explicit ThreadPool(int num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Executa fn(0) ... fn(count-1) no pool e espera que terminem todas
+     *
+     * Pode ser chamado de dentro de uma tarefa do próprio pool.
+     */
+    void parallel_for(size_t count, const std::function<void(size_t)>& fn);
+
+    /**
+     * @brief Número total de threads (incluindo a que chama parallel_for)
+     */
+    int size() const { return static_cast<int>(m_workers.size()) + 1; }
+};
+
+#endif
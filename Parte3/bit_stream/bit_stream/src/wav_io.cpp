@@ -0,0 +1,532 @@
+//-------------------------------------------------------------------------------------------
+//
+// WAV I/O - Implementação
+//
+// Os cabeçalhos são lidos e escritos campo a campo em little-endian; as amostras
+// assumem um processador little-endian, como o resto dos codecs.
+//
+//-------------------------------------------------------------------------------------------
+
+#include "wav_io.h"
+#include "dct_kernels.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <type_traits>
+
+#ifdef WAV_IO_HAS_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define WAV_IO_X86
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// Códigos do formato no chunk "fmt " (e nos dois primeiros bytes do GUID do subformato)
+const int WAV_FORMAT_PCM = 1;
+const int WAV_FORMAT_FLOAT = 3;
+const int WAV_FORMAT_EXTENSIBLE = 0xFFFE;
+
+static uint16_t le16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+static uint32_t le32(const uint8_t* p) {
+    return static_cast<uint32_t>(le16(p)) | (static_cast<uint32_t>(le16(p + 2)) << 16);
+}
+
+static uint64_t le64(const uint8_t* p) {
+    return static_cast<uint64_t>(le32(p)) | (static_cast<uint64_t>(le32(p + 4)) << 32);
+}
+
+int wav_sample_bytes(WAVSampleFormat format) {
+    switch (format) {
+        case WAVSampleFormat::PCM_U8:   return 1;
+        case WAVSampleFormat::PCM_16:   return 2;
+        case WAVSampleFormat::PCM_24:   return 3;
+        case WAVSampleFormat::FLOAT_64: return 8;
+        default:                        return 4;
+    }
+}
+
+const char* wav_format_name(WAVSampleFormat format) {
+    switch (format) {
+        case WAVSampleFormat::PCM_U8:   return "PCM 8 bits";
+        case WAVSampleFormat::PCM_16:   return "PCM 16 bits";
+        case WAVSampleFormat::PCM_24:   return "PCM 24 bits";
+        case WAVSampleFormat::PCM_32:   return "PCM 32 bits";
+        case WAVSampleFormat::FLOAT_32: return "float 32 bits";
+        default:                        return "float 64 bits";
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// Conversão para 16 bits - escalar
+//
+// Inteiros: o valor fica nos 16 bits altos de um int32 (y) e arredonda-se com
+// (y >> 16) + bit 15, saturando o único caso que passa de 32767
+//-------------------------------------------------------------------------------------------
+static short round_high_16(int32_t y) {
+    return static_cast<short>(min((y >> 16) + ((y >> 15) & 1), 32767));
+}
+
+// O NaN passa a -32768, como em _mm256_max_ps
+static short float_to_16(double v) {
+    v *= 32768.0;
+    v = (v > -32768.0) ? v : -32768.0;
+    v = (v < 32767.0) ? v : 32767.0;
+    return static_cast<short>(nearbyint(v));
+}
+
+static void convert_scalar(const uint8_t* src, WAVSampleFormat format, short* dst, size_t count) {
+    switch (format) {
+        case WAVSampleFormat::PCM_U8:
+            for (size_t i = 0; i < count; i++) {
+                dst[i] = static_cast<short>((src[i] - 128) * 256);
+            }
+            break;
+        case WAVSampleFormat::PCM_16:
+            memcpy(dst, src, count * sizeof(short));
+            break;
+        case WAVSampleFormat::PCM_24:
+            for (size_t i = 0; i < count; i++) {
+                const uint8_t* p = src + 3 * i;
+                dst[i] = round_high_16(static_cast<int32_t>((p[0] << 8) | (p[1] << 16) | (static_cast<uint32_t>(p[2]) << 24)));
+            }
+            break;
+        case WAVSampleFormat::PCM_32:
+            for (size_t i = 0; i < count; i++) {
+                int32_t y;
+                memcpy(&y, src + 4 * i, 4);
+                dst[i] = round_high_16(y);
+            }
+            break;
+        case WAVSampleFormat::FLOAT_32:
+            for (size_t i = 0; i < count; i++) {
+                float v;
+                memcpy(&v, src + 4 * i, 4);
+                dst[i] = float_to_16(v);
+            }
+            break;
+        case WAVSampleFormat::FLOAT_64:
+            for (size_t i = 0; i < count; i++) {
+                double v;
+                memcpy(&v, src + 8 * i, 8);
+                dst[i] = float_to_16(v);
+            }
+            break;
+    }
+}
+
+#ifdef WAV_IO_X86
+
+//-------------------------------------------------------------------------------------------
+// Conversão para 16 bits - AVX2 (16 amostras por iteração, 8 em float 64)
+// Retorna o número de amostras convertidas; o resto fica para a versão escalar.
+//-------------------------------------------------------------------------------------------
+__attribute__((target("avx2")))
+static inline __m256i round_high_16_avx2(__m256i y) {
+    return _mm256_add_epi32(_mm256_srai_epi32(y, 16), _mm256_and_si256(_mm256_srai_epi32(y, 15), _mm256_set1_epi32(1)));
+}
+
+// Dois vetores de 8 int32 para 16 int16 pela ordem original (packs trabalha por
+// metades de 128 bits)
+__attribute__((target("avx2")))
+static inline void store_packed_avx2(short* dst, __m256i a, __m256i b) {
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xD8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), packed);
+}
+
+// 8 amostras de 24 bits nos 24 bits altos de cada int32, arredondadas: cada metade de
+// 128 bits recebe 4 amostras (12 bytes), mas as cargas de 16 bytes leem mais 4 bytes
+__attribute__((target("avx2")))
+static inline __m256i load_pcm24_avx2(const uint8_t* p) {
+    const __m256i shuffle = _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+                                             -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))),
+                                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 12)), 1);
+    return round_high_16_avx2(_mm256_shuffle_epi8(v, shuffle));
+}
+
+// 8 (float 32) ou 4 (float 64) amostras escaladas, saturadas e arredondadas
+__attribute__((target("avx2")))
+static inline __m256i load_float32_avx2(const uint8_t* p) {
+    __m256 v = _mm256_mul_ps(_mm256_loadu_ps(reinterpret_cast<const float*>(p)), _mm256_set1_ps(32768.0f));
+    return _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(v, _mm256_set1_ps(-32768.0f)), _mm256_set1_ps(32767.0f)));
+}
+
+__attribute__((target("avx2")))
+static inline __m128i load_float64_avx2(const uint8_t* p) {
+    __m256d v = _mm256_mul_pd(_mm256_loadu_pd(reinterpret_cast<const double*>(p)), _mm256_set1_pd(32768.0));
+    return _mm256_cvtpd_epi32(_mm256_min_pd(_mm256_max_pd(v, _mm256_set1_pd(-32768.0)), _mm256_set1_pd(32767.0)));
+}
+
+__attribute__((target("avx2")))
+static size_t convert_avx2(const uint8_t* src, WAVSampleFormat format, short* dst, size_t count) {
+    size_t i = 0;
+    switch (format) {
+        case WAVSampleFormat::PCM_U8: {
+            const __m256i offset = _mm256_set1_epi16(128);
+            for (; i + 16 <= count; i += 16) {
+                __m256i x = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_slli_epi16(_mm256_sub_epi16(x, offset), 8));
+            }
+            break;
+        }
+        case WAVSampleFormat::PCM_24:
+            // Os 4 bytes lidos a mais obrigam a deixar pelo menos 2 amostras para o fim
+            for (; i + 18 <= count; i += 16) {
+                store_packed_avx2(dst + i, load_pcm24_avx2(src + 3 * i), load_pcm24_avx2(src + 3 * i + 24));
+            }
+            break;
+        case WAVSampleFormat::PCM_32:
+            for (; i + 16 <= count; i += 16) {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4 * i));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4 * i + 32));
+                store_packed_avx2(dst + i, round_high_16_avx2(a), round_high_16_avx2(b));
+            }
+            break;
+        case WAVSampleFormat::FLOAT_32:
+            for (; i + 16 <= count; i += 16) {
+                store_packed_avx2(dst + i, load_float32_avx2(src + 4 * i), load_float32_avx2(src + 4 * i + 32));
+            }
+            break;
+        case WAVSampleFormat::FLOAT_64:
+            for (; i + 8 <= count; i += 8) {
+                __m128i packed = _mm_packs_epi32(load_float64_avx2(src + 8 * i), load_float64_avx2(src + 8 * i + 32));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+            }
+            break;
+        default:
+            break;
+    }
+    return i;
+}
+
+#endif
+
+void wav_convert_to_16(const uint8_t* src, WAVSampleFormat format, short* dst, size_t count) {
+    size_t done = 0;
+#ifdef WAV_IO_X86
+    if (format != WAVSampleFormat::PCM_16 && dct_kernels().isa == KernelISA::AVX2) {
+        done = convert_avx2(src, format, dst, count);
+    }
+#endif
+    convert_scalar(src + done * wav_sample_bytes(format), format, dst + done, count - done);
+}
+
+//-------------------------------------------------------------------------------------------
+// Leitura incremental de ficheiro WAV
+//-------------------------------------------------------------------------------------------
+WAVReader::WAVReader()
+    : m_header(), m_format(WAVSampleFormat::PCM_16), m_num_samples(0), m_position(0), m_rf64(false),
+      m_map(nullptr), m_map_size(0), m_data(nullptr), m_available(0) {}
+
+WAVReader::~WAVReader() {
+    unmap_file();
+}
+
+bool WAVReader::map_file(const string& filename) {
+#ifdef WAV_IO_HAS_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);    // O mapeamento mantém a sua referência ao ficheiro
+    if (map == MAP_FAILED) return false;
+
+    madvise(map, st.st_size, MADV_SEQUENTIAL);
+    m_map = static_cast<const uint8_t*>(map);
+    m_map_size = st.st_size;
+    return true;
+#else
+    (void)filename;
+    return false;
+#endif
+}
+
+void WAVReader::unmap_file() {
+#ifdef WAV_IO_HAS_MMAP
+    if (m_map != nullptr) {
+        munmap(const_cast<uint8_t*>(m_map), m_map_size);
+        m_map = m_data = nullptr;
+        m_map_size = 0;
+    }
+#endif
+}
+
+bool WAVReader::open(const string& filename) {
+    WAVHeader& header = m_header;
+    ifstream& file = m_file;
+
+    file.open(filename, ios::binary);
+    if (!file.is_open()) {
+        cerr << "Erro: não foi possível abrir " << filename << endl;
+        return false;
+    }
+
+    // RIFF (ou RF64/BW64) header
+    uint8_t bytes[40];
+    if (!file.read(reinterpret_cast<char*>(bytes), 12) ||
+        (memcmp(bytes, "RIFF", 4) != 0 && memcmp(bytes, "RF64", 4) != 0 && memcmp(bytes, "BW64", 4) != 0) ||
+        memcmp(bytes + 8, "WAVE", 4) != 0) {
+        cerr << "Erro: formato WAV inválido" << endl;
+        return false;
+    }
+    memcpy(header.riff, bytes, 4);
+    header.file_size = static_cast<int>(le32(bytes + 4));
+    memcpy(header.wave, "WAVE", 4);
+    m_rf64 = memcmp(bytes, "RIFF", 4) != 0;
+
+    // Percorrer os chunks até "data"; em RF64 o tamanho de "data" vem no "ds64"
+    uint64_t ds64_data_size = 0;
+    bool found_fmt = false;
+    char chunk_id[4];
+
+    while (file.read(chunk_id, 4) && file.read(reinterpret_cast<char*>(bytes), 4)) {
+        uint64_t chunk_size = le32(bytes);
+
+        if (memcmp(chunk_id, "ds64", 4) == 0 && chunk_size >= 24) {
+            file.read(reinterpret_cast<char*>(bytes), 24);
+            ds64_data_size = le64(bytes + 8);
+            file.ignore(chunk_size - 24 + (chunk_size & 1));
+            continue;
+        }
+
+        if (memcmp(chunk_id, "fmt ", 4) == 0 && chunk_size >= 16) {
+            size_t size = static_cast<size_t>(min<uint64_t>(chunk_size, sizeof(bytes)));
+            file.read(reinterpret_cast<char*>(bytes), size);
+            memcpy(header.fmt, "fmt ", 4);
+            header.fmt_size = static_cast<int>(chunk_size);
+            header.audio_format = static_cast<short>(le16(bytes));
+            header.num_channels = static_cast<short>(le16(bytes + 2));
+            header.sample_rate = static_cast<int>(le32(bytes + 4));
+            header.byte_rate = static_cast<int>(le32(bytes + 8));
+            header.block_align = static_cast<short>(le16(bytes + 12));
+            header.bits_per_sample = static_cast<short>(le16(bytes + 14));
+
+            // Em WAVE_FORMAT_EXTENSIBLE o formato são os 2 primeiros bytes do GUID
+            int tag = le16(bytes);
+            if (tag == WAV_FORMAT_EXTENSIBLE && size >= 40) {
+                tag = le16(bytes + 24);
+            }
+
+            int bits = header.bits_per_sample;
+            if (tag == WAV_FORMAT_PCM && bits == 8) m_format = WAVSampleFormat::PCM_U8;
+            else if (tag == WAV_FORMAT_PCM && bits == 16) m_format = WAVSampleFormat::PCM_16;
+            else if (tag == WAV_FORMAT_PCM && bits == 24) m_format = WAVSampleFormat::PCM_24;
+            else if (tag == WAV_FORMAT_PCM && bits == 32) m_format = WAVSampleFormat::PCM_32;
+            else if (tag == WAV_FORMAT_FLOAT && bits == 32) m_format = WAVSampleFormat::FLOAT_32;
+            else if (tag == WAV_FORMAT_FLOAT && bits == 64) m_format = WAVSampleFormat::FLOAT_64;
+            else {
+                cerr << "Erro: formato de amostras não suportado (formato " << tag << ", "
+                     << bits << " bits)" << endl;
+                return false;
+            }
+
+            if (header.num_channels < 1) {
+                cerr << "Erro: número de canais inválido" << endl;
+                return false;
+            }
+            if (header.block_align != header.num_channels * wav_sample_bytes(m_format)) {
+                cerr << "Erro: block_align inválido no chunk 'fmt '" << endl;
+                return false;
+            }
+
+            found_fmt = true;
+            file.ignore(chunk_size - size + (chunk_size & 1));
+            continue;
+        }
+
+        if (memcmp(chunk_id, "data", 4) == 0) {
+            if (!found_fmt) {
+                cerr << "Erro: chunk 'fmt ' não encontrado" << endl;
+                return false;
+            }
+            if (m_rf64 && chunk_size == 0xFFFFFFFF) {
+                chunk_size = ds64_data_size;
+            }
+            memcpy(header.data, "data", 4);
+            header.data_size = static_cast<int>(min<uint64_t>(chunk_size, 0xFFFFFFFF));
+            m_num_samples = chunk_size / wav_sample_bytes(m_format);
+            m_position = 0;
+
+            // Mapear o ficheiro; sem mapeamento as amostras são lidas a partir daqui
+            uint64_t data_offset = static_cast<uint64_t>(file.tellg());
+            if (map_file(filename) && data_offset <= m_map_size) {
+                m_data = m_map + data_offset;
+                m_available = min<uint64_t>(m_num_samples, (m_map_size - data_offset) / wav_sample_bytes(m_format));
+            }
+            return true;
+        }
+
+        file.ignore(chunk_size + (chunk_size & 1));
+    }
+
+    cerr << (found_fmt ? "Erro: chunk 'data' não encontrado" : "Erro: chunk 'fmt ' não encontrado") << endl;
+    return false;
+}
+
+size_t WAVReader::read(short* buffer, size_t count) {
+    count = static_cast<size_t>(min<uint64_t>(count, m_num_samples - m_position));
+    int sample_bytes = wav_sample_bytes(m_format);
+    size_t got = 0;
+
+    if (m_data != nullptr) {
+        got = static_cast<size_t>(min<uint64_t>(count, m_available - min(m_available, m_position)));
+        wav_convert_to_16(m_data + m_position * sample_bytes, m_format, buffer, got);
+    } else if (m_format == WAVSampleFormat::PCM_16) {
+        m_file.read(reinterpret_cast<char*>(buffer), count * sizeof(short));
+        got = static_cast<size_t>(max<streamsize>(m_file.gcount(), 0)) / sizeof(short);
+    } else {
+        m_raw.resize(count * sample_bytes);
+        m_file.read(reinterpret_cast<char*>(m_raw.data()), m_raw.size());
+        got = static_cast<size_t>(max<streamsize>(m_file.gcount(), 0)) / sample_bytes;
+        wav_convert_to_16(m_raw.data(), m_format, buffer, got);
+    }
+    fill(buffer + got, buffer + count, 0);
+
+    m_position += count;
+    return count;
+}
+
+//-------------------------------------------------------------------------------------------
+// Vista sem cópia das amostras mapeadas
+//-------------------------------------------------------------------------------------------
+template <typename T>
+static bool format_stores(WAVSampleFormat format) {
+    if constexpr (is_same_v<T, uint8_t>) return format == WAVSampleFormat::PCM_U8;
+    if constexpr (is_same_v<T, int16_t>) return format == WAVSampleFormat::PCM_16;
+    if constexpr (is_same_v<T, int32_t>) return format == WAVSampleFormat::PCM_32;
+    if constexpr (is_same_v<T, float>) return format == WAVSampleFormat::FLOAT_32;
+    if constexpr (is_same_v<T, double>) return format == WAVSampleFormat::FLOAT_64;
+    return false;
+}
+
+template <typename T>
+span<const T> WAVReader::view() const {
+    if (m_data == nullptr || !format_stores<T>(m_format) ||
+        reinterpret_cast<uintptr_t>(m_data) % alignof(T) != 0) {
+        return {};
+    }
+    return { reinterpret_cast<const T*>(m_data), static_cast<size_t>(m_available) };
+}
+
+template span<const uint8_t> WAVReader::view<uint8_t>() const;
+template span<const int16_t> WAVReader::view<int16_t>() const;
+template span<const int32_t> WAVReader::view<int32_t>() const;
+template span<const float> WAVReader::view<float>() const;
+template span<const double> WAVReader::view<double>() const;
+
+span<const uint8_t> WAVReader::raw_data() const {
+    if (m_data == nullptr) return {};
+    return { m_data, static_cast<size_t>(m_available * wav_sample_bytes(m_format)) };
+}
+
+//-------------------------------------------------------------------------------------------
+// Leitura de ficheiro WAV
+//-------------------------------------------------------------------------------------------
+bool read_wav_file(const string& filename, WAVHeader& header, vector<short>& samples) {
+    WAVReader reader;
+    if (!reader.open(filename)) {
+        return false;
+    }
+
+    header = reader.header();
+    samples.resize(reader.num_samples());
+    reader.read(samples.data(), samples.size());
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------
+// Escrita de ficheiro WAV
+//-------------------------------------------------------------------------------------------
+bool write_wav_file(const string& filename, const WAVHeader& header, const vector<short>& samples) {
+    WAVWriter writer;
+    if (!writer.open(filename, header.sample_rate, header.num_channels)) {
+        return false;
+    }
+    writer.write(samples.data(), samples.size());
+    return writer.close();
+}
+
+//-------------------------------------------------------------------------------------------
+// Escrita incremental de ficheiro WAV
+//-------------------------------------------------------------------------------------------
+WAVWriter::WAVWriter() : m_sample_rate(0), m_num_channels(1), m_num_samples(0) {}
+
+WAVWriter::~WAVWriter() {
+    if (m_file.is_open()) close();
+}
+
+static void put_le(ostream& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.put(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+void WAVWriter::write_header() {
+    uint64_t data_size = min<uint64_t>(m_num_samples * sizeof(short), 0xFFFFFFFF - 36);
+    int block_align = m_num_channels * static_cast<int>(sizeof(short));
+
+    m_file.write("RIFF", 4);
+    put_le(m_file, 36 + data_size, 4);
+    m_file.write("WAVE", 4);
+    m_file.write("fmt ", 4);
+    put_le(m_file, 16, 4);                              // Tamanho do chunk "fmt "
+    put_le(m_file, WAV_FORMAT_PCM, 2);
+    put_le(m_file, m_num_channels, 2);
+    put_le(m_file, m_sample_rate, 4);
+    put_le(m_file, static_cast<uint64_t>(m_sample_rate) * block_align, 4);   // Byte rate
+    put_le(m_file, block_align, 2);
+    put_le(m_file, 16, 2);                              // Bits por amostra
+    m_file.write("data", 4);
+    put_le(m_file, data_size, 4);
+}
+
+bool WAVWriter::open(const string& filename, int sample_rate, int num_channels) {
+    m_file.open(filename, ios::binary);
+    if (!m_file.is_open()) {
+        cerr << "Erro: não foi possível criar " << filename << endl;
+        return false;
+    }
+
+    // Cabeçalho provisório, corrigido em close()
+    m_sample_rate = sample_rate;
+    m_num_channels = num_channels;
+    m_num_samples = 0;
+    write_header();
+    return m_file.good();
+}
+
+void WAVWriter::write(const short* samples, size_t count) {
+    m_file.write(reinterpret_cast<const char*>(samples), count * sizeof(short));
+    m_num_samples += count;
+}
+
+bool WAVWriter::close() {
+    m_file.seekp(0, ios::beg);
+    write_header();
+
+    bool ok = m_file.good();
+    m_file.close();
+
+    if (m_num_samples * sizeof(short) > 0xFFFFFFFF - 36) {
+        cerr << "Erro: dados acima do limite de 4 GB de um ficheiro WAV" << endl;
+        return false;
+    }
+    return ok;
+}
@@ -0,0 +1,211 @@
+//-------------------------------------------------------------------------------------------
+//
+// WAV I/O - Leitura e escrita de ficheiros WAV
+//
+// Lê PCM de 8/16/24/32 bits e vírgula flutuante de 32/64 bits, com o formato no chunk
+// "fmt " simples ou WAVE_FORMAT_EXTENSIBLE, em ficheiros RIFF ou RF64/BW64 (tamanhos
+// de 64 bits no chunk "ds64"). O chunk "data" é mapeado em memória quando possível:
+// as amostras podem ser lidas diretamente (view) ou convertidas para 16 bits, o tipo
+// usado pelos codecs, em lotes vetorizados.
+//
+//-------------------------------------------------------------------------------------------
+
+#ifndef WAV_IO_H
+#define WAV_IO_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+#include <span>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WAV_IO_HAS_MMAP
+#endif
+
+/**
+ * @brief Formato das amostras no chunk "data"
+ */
+enum class WAVSampleFormat {
+    PCM_U8,     // Inteiro sem sinal, 8 bits (128 = silêncio)
+    PCM_16,
+    PCM_24,     // Inteiro com sinal em 3 bytes (little-endian)
+    PCM_32,
+    FLOAT_32,   // IEEE 754, escala [-1, 1]
+    FLOAT_64
+};
+
+/**
+ * @brief Bytes de uma amostra no formato dado
+ */
+int wav_sample_bytes(WAVSampleFormat format);
+
+/**
+ * @brief Nome do formato (ex: "PCM 24 bits")
+ */
+const char* wav_format_name(WAVSampleFormat format);
+
+/**
+ * @brief Converte amostras para 16 bits com arredondamento e saturação
+ *
+ * Inteiros de mais de 16 bits são arredondados ao múltiplo mais próximo de
+ * 2^(bits-16); vírgula flutuante é multiplicada por 32768 e arredondada (ao par mais
+ * próximo). Usa AVX2 quando os kernels ativos (dct_kernels) o permitem; o resultado
+ * é idêntico ao da versão escalar.
+ * @param src Amostras no formato do ficheiro (sem requisitos de alinhamento)
+ * @param count Número de amostras (contando todos os canais)
+ */
+void wav_convert_to_16(const uint8_t* src, WAVSampleFormat format, short* dst, size_t count);
+
+/**
+ * @brief Campos do cabeçalho de um ficheiro WAV
+ *
+ * Descrição do ficheiro preenchida por WAVReader (e usada por write_wav_file); não
+ * corresponde byte a byte ao ficheiro, que é lido e escrito campo a campo.
+ */
+struct WAVHeader {
+    char riff[4];              // "RIFF" (ou "RF64"/"BW64")
+    int file_size;             // Tamanho do ficheiro - 8 (0xFFFFFFFF em RF64)
+    char wave[4];              // "WAVE"
+    char fmt[4];               // "fmt "
+    int fmt_size;              // 16 para PCM, 40 em WAVE_FORMAT_EXTENSIBLE
+    short audio_format;        // 1 = PCM, 3 = vírgula flutuante, 0xFFFE = extensible
+    short num_channels;        // 1 para mono, 2 para estéreo, ...
+    int sample_rate;           // Ex: 44100
+    int byte_rate;             // sample_rate * num_channels * bits_per_sample / 8
+    short block_align;         // num_channels * bits_per_sample / 8
+    short bits_per_sample;     // 8, 16, 24, 32 ou 64
+    char data[4];              // "data"
+    int data_size;             // Tamanho dos dados de áudio (0xFFFFFFFF em RF64)
+};
+
+/**
+ * @brief Lê cabeçalho e amostras (intercaladas por canal, convertidas para 16 bits)
+ *        de um ficheiro WAV
+ * @param filename Nome do ficheiro WAV
+ * @param header Estrutura para armazenar o cabeçalho
+ * @param samples Vetor para armazenar as amostras
+ * @return true se sucesso, false caso contrário
+ */
+bool read_wav_file(const std::string& filename, WAVHeader& header, std::vector<short>& samples);
+
+/**
+ * @brief Escreve um ficheiro WAV PCM 16-bit com as amostras dadas
+ * @param filename Nome do ficheiro WAV
+ * @param header Cabeçalho WAV (só são usados sample_rate e num_channels)
+ * @param samples Vetor com as amostras
+ * @return true se sucesso, false caso contrário
+ */
+bool write_wav_file(const std::string& filename, const WAVHeader& header, const std::vector<short>& samples);
+
+/**
+ * @brief Leitura incremental das amostras de um ficheiro WAV
+ *
+ * A abertura só lê os chunks até "data". Num ficheiro regular o chunk "data" fica
+ * mapeado em memória e read() converte diretamente do mapeamento; nos restantes
+ * (pipes, sistemas sem mmap) as amostras são lidas aos pedaços do ficheiro. Em
+ * qualquer caso a memória usada não depende do tamanho do ficheiro.
+ */
+class WAVReader {
+private:
+    std::ifstream m_file;
+    WAVHeader m_header;
+    WAVSampleFormat m_format;
+    uint64_t m_num_samples;     // Amostras declaradas no chunk "data"
+    uint64_t m_position;        // Amostras já lidas
+    bool m_rf64;
+
+    // Mapeamento do ficheiro (nullptr sem mmap) e início do chunk "data" nele;
+    // m_available é o número de amostras que existem de facto no ficheiro
+    const uint8_t* m_map;
+    size_t m_map_size;
+    const uint8_t* m_data;
+    uint64_t m_available;
+    std::vector<uint8_t> m_raw; // Amostras lidas do ficheiro antes da conversão (sem mmap)
+
+    bool map_file(const std::string& filename);
+    void unmap_file();
+
+public:
+    WAVReader();
+    ~WAVReader();
+
+    WAVReader(const WAVReader&) = delete;
+    WAVReader& operator=(const WAVReader&) = delete;
+
+    /**
+     * @brief Abre o ficheiro e posiciona-o no início do chunk "data"
+     * @return true se sucesso (mensagem de erro em cerr caso contrário)
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Lê as próximas amostras, convertidas para 16 bits
+     * @param buffer Destino (pelo menos count amostras)
+     * @param count Número de amostras pedidas (contando todos os canais)
+     * @return Amostras lidas (menos que count só no fim do chunk "data");
+     *         num ficheiro truncado as amostras em falta são lidas como zero
+     */
+    size_t read(short* buffer, size_t count);
+
+    /**
+     * @brief Amostras do chunk "data" no formato do ficheiro, sem cópia
+     *
+     * T tem de ser o tipo do formato (uint8_t, int16_t, int32_t, float ou double;
+     * PCM de 24 bits só tem raw_data()). Vazio sem mapeamento, com outro tipo ou se
+     * o chunk não estiver alinhado para T. Não depende de read().
+     */
+    template <typename T>
+    std::span<const T> view() const;
+
+    /**
+     * @brief Bytes do chunk "data" existentes no ficheiro (vazio sem mapeamento)
+     */
+    std::span<const uint8_t> raw_data() const;
+
+    const WAVHeader& header() const { return m_header; }
+    WAVSampleFormat format() const { return m_format; }
+    uint64_t num_samples() const { return m_num_samples; }
+    bool is_rf64() const { return m_rf64; }
+    bool is_mapped() const { return m_map != nullptr; }
+};
+
+/**
+ * @brief Escrita incremental de um ficheiro WAV PCM 16-bit
+ *
+ * O cabeçalho (44 bytes, escrito campo a campo em little-endian) é escrito na
+ * abertura com tamanhos a zero e corrigido em close(), quando já se sabe quantas
+ * amostras foram escritas.
+ */
+class WAVWriter {
+private:
+    std::ofstream m_file;
+    int m_sample_rate;
+    int m_num_channels;
+    uint64_t m_num_samples;
+
+    void write_header();
+
+public:
+    WAVWriter();
+    ~WAVWriter();
+
+    /**
+     * @brief Cria o ficheiro e escreve o cabeçalho provisório
+     */
+    bool open(const std::string& filename, int sample_rate, int num_channels = 1);
+
+    /**
+     * @brief Acrescenta amostras (intercaladas por canal) ao chunk "data"
+     */
+    void write(const short* samples, size_t count);
+
+    /**
+     * @brief Corrige os tamanhos RIFF/data no cabeçalho e fecha o ficheiro
+     * @return false se alguma escrita falhou ou os dados passam de 4 GB
+     */
+    bool close();
+};
+
+#endif